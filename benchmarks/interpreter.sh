@@ -0,0 +1,31 @@
+#!/bin/bash
+# time minibash spends on its own work, a loop which parses, expands and runs builtins and a function
+# nothing is forked inside the loop, all the time is spent in minibash
+# usage: benchmarks/interpreter.sh [minibash binary] [iterations]
+
+minibash=$(realpath "${1:-./minibash}")
+iterations=${2:-100000}
+
+directory=$(mktemp -d)
+trap 'rm -rf "$directory"' EXIT
+
+cat > "$directory/script" <<SCRIPT
+greet() {
+    NAME=\$1
+    alias hello=echo
+}
+for i in \$(seq 1 $iterations); do
+    X=\$i
+    greet \$X
+    cd /
+    set pipesize=0
+    export X
+    hash ls
+done
+SCRIPT
+
+start=$(date +%s.%N)
+"$minibash" "$directory/script" > /dev/null
+end=$(date +%s.%N)
+awk -v start="$start" -v end="$end" -v iterations="$iterations" \
+    'BEGIN { printf "%-16s %10.3f s %10.1f us/iteration\n", "interpreter", end - start, (end - start) / iterations * 1000000 }'
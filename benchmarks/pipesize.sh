@@ -0,0 +1,33 @@
+#!/bin/bash
+# throughput of cat | grep | wc and cat | cat | wc through minibash for different pipe sizes
+# grep shows a pipeline bound by a command, cat a pipeline bound by moving data through pipes
+# usage: benchmarks/pipesize.sh [minibash binary] [size of data in MB]
+# sizes above /proc/sys/fs/pipe-max-size need root, pipes keep their size otherwise
+
+minibash=$(realpath "${1:-./minibash}")
+megabytes=${2:-512}
+runs=3
+
+directory=$(mktemp -d)
+trap 'rm -rf "$directory"' EXIT
+
+# text lines, so that grep has real work to do, every line goes through every pipe
+base64 -w 100 < <(head -c $((megabytes * 1024 * 1024 * 3 / 4)) /dev/urandom) > "$directory/data"
+bytes=$(stat -c %s "$directory/data")
+
+printf "%-16s %-10s %10s %10s\n" "pipeline" "pipesize" "best(s)" "MB/s"
+for middle in "grep -v zzzzzz" "cat"; do
+    for size in 0 64K 256K 1M 4M; do
+        printf 'set pipesize=%s\ncat %s | %s | wc -c\n' "$size" "$directory/data" "$middle" > "$directory/script"
+        best=
+        for ((run = 0; run < runs; run++)); do
+            start=$(date +%s.%N)
+            "$minibash" "$directory/script" > /dev/null
+            end=$(date +%s.%N)
+            best=$(awk -v start="$start" -v end="$end" -v best="$best" \
+                'BEGIN { seconds = end - start; print (best == "" || seconds < best) ? seconds : best }')
+        done
+        awk -v middle="${middle%% *}" -v size="${size/#0/default}" -v best="$best" -v bytes="$bytes" \
+            'BEGIN { printf "%-16s %-10s %10.3f %10.1f\n", "cat|" middle "|wc", size, best, bytes / best / 1000000 }'
+    done
+done
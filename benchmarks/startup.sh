@@ -0,0 +1,18 @@
+#!/bin/bash
+# time to start minibash and run one command, minibash -c true against /bin/sh -c true and /bin/true
+# every run includes the fork and exec of bash running this loop, /bin/true shows what that costs
+# usage: benchmarks/startup.sh [minibash binary] [runs]
+
+minibash=$(realpath "${1:-./minibash}")
+runs=${2:-2000}
+
+printf "%-24s %10s\n" "command" "us/run"
+for command in "/bin/true" "/bin/sh -c true" "$minibash -c true" "$minibash -c cd"; do
+    start=$(date +%s.%N)
+    for ((run = 0; run < runs; run++)); do
+        $command
+    done
+    end=$(date +%s.%N)
+    awk -v command="${command/#$minibash/minibash}" -v start="$start" -v end="$end" -v runs="$runs" \
+        'BEGIN { printf "%-24s %10.1f\n", command, (end - start) / runs * 1000000 }'
+done
@@ -0,0 +1,46 @@
+#!/bin/bash
+# compares what the parser of minibash and bash -n say about lines of the grammar minibash supports
+# lines come from fuzz/differential.txt and from joining up to 4 commands, some of them missing, with ;, | or && and ||
+# usage: fuzz/differential.sh [parser_fuzzer binary]
+
+fuzzer=$(realpath "${1:-build/parser_fuzzer}")
+
+directory=$(mktemp -d)
+trap 'rm -rf "$directory"' EXIT
+
+# expected<TAB>line, expected is same or differs
+grep -v '^#' "$(dirname "$0")/differential.txt" > "$directory/cases"
+
+commands=("ls" "wc -l a" "")
+for operators in ";" "|" "&& ||"; do
+    read -r -a operator <<< "$operators"
+    for ((count = 2; count <= 4; count++)); do
+        for ((combination = 0; combination < 3 ** count; combination++)); do
+            line= missing=
+            for ((i = 0, rest = combination; i < count; i++, rest /= 3)); do
+                word=${commands[rest % 3]}
+                if ((i > 0)); then
+                    line+=" ${operator[(i - 1) % ${#operator[@]}]} "
+                fi
+                line+=$word
+                missing+=$([ -z "$word" ] && echo 1 || echo 0)
+            done
+            # only the last command missing after ; is fine for bash, not for minibash
+            expected=same
+            if [ "$operators" = ";" ] && [[ $missing =~ ^0+1$ ]]; then
+                expected=differs
+            fi
+            printf '%s\t%s\n' "$expected" "$line" >> "$directory/cases"
+        done
+    done
+done
+
+cut -f2- "$directory/cases" > "$directory/lines"
+"$fuzzer" -verdict "$directory/lines" > "$directory/minibash" || exit 1
+while IFS= read -r line; do
+    bash -n -c "$line" 2> /dev/null && echo ok || echo error
+done < "$directory/lines" > "$directory/bash"
+
+paste "$directory/minibash" "$directory/bash" "$directory/cases" | awk -F '\t' '
+    ($3 == "same") != ($1 == $2) { failed++; printf "%s: minibash says %s, bash -n says %s: %s\n", $3 == "same" ? "differs" : "agrees now", $1, $2, $4 }
+    END { printf "%d lines, %d unexpected\n", NR, failed; exit failed > 0 }'
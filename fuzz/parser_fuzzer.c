@@ -0,0 +1,219 @@
+// fuzz target for the parser of minibash, input is parsed the way a script is and every command is compiled
+// into a plan, nothing is run, so no process is ever started
+//
+// libFuzzer: make fuzz
+// AFL:       afl-gcc -o parser_fuzzer fuzz/parser_fuzzer.c
+//            afl-fuzz -i fuzz/corpus -o findings -- ./parser_fuzzer @@
+// without either, built by make test:
+//   parser_fuzzer FILE...           parses every file, standard input when no file is given
+//   parser_fuzzer -generate N SEED  parses N random inputs made of tokens minibash knows
+//   parser_fuzzer -verdict FILE     parses every line of FILE on its own, prints ok or error for each
+
+#include "../libminibash.c"
+
+#include <stdint.h>
+
+#define FUZZ_INPUT_MAX 65536
+
+// interpreter whose aliases the parser replaces, it's never entered since nothing is run
+struct minibash *fuzz_interpreter = NULL;
+
+// compiles every command of list like running it would, keeps plans in statements so they are freed with them
+// returns number of commands which failed to compile
+int compile_statements(struct minibash *interpreter, struct statement_list *list)
+{
+    int errors = 0;
+
+    for (int i = 0; i < list->count; i++)
+    {
+        struct statement *statement = &list->statements[i];
+        if (statement->kind == STATEMENT_COMMAND && !statement->plan)
+        {
+            statement->plan = malloc(sizeof(struct command_plan));
+            errors += compile_plan(interpreter, statement->plan, statement->text) == -1;
+        }
+        errors += compile_statements(interpreter, &statement->condition);
+        errors += compile_statements(interpreter, &statement->body);
+        errors += compile_statements(interpreter, &statement->else_body);
+        if (statement->function)
+        {
+            errors += compile_statements(interpreter, &statement->function->body);
+        }
+    }
+    return errors;
+}
+
+// parses pieces read so far and compiles their commands, then clears them, like run_pieces without running
+// returns number of errors
+int parse_and_compile(struct minibash *interpreter, struct script_pieces *pieces)
+{
+    struct statement_list list = {NULL, 0, 0};
+
+    // after a syntax error list is left half made, run_pieces doesn't run it either
+    int errors = parse_pieces(pieces, &list) == -1 ? 1 : compile_statements(interpreter, &list);
+    free_statements(&list);
+    clear_pieces(pieces);
+    return errors;
+}
+
+// parses lines of text like a script, the way run_script_lines reads them, comments are skipped and bodies
+// of here documents are read from the lines after them
+// returns number of errors
+int parse_text(struct minibash *interpreter, char *text)
+{
+    struct script_pieces pieces = {NULL, 0, 0, 0};
+    struct string_buffer line;
+    int errors = 0;
+    size_t length = strlen(text);
+
+    // input is only read, mode r doesn't write to it
+    FILE *fd = length > 0 ? fmemopen(text, length, "r") : NULL;
+    if (!fd)
+    {
+        return 0;
+    }
+
+    string_buffer_init(&line);
+    while (string_buffer_read_line(&line, fd) != -1)
+    {
+        if (line.data[strspn(line.data, " \t")] == '#' || line.length == 0)
+        {
+            continue;
+        }
+        char *bodies = read_here_documents(interpreter, line.data, fd);
+        add_script_line(&pieces, line.data, bodies);
+        free(bodies);
+        if (pieces.depth <= 0)
+        {
+            errors += parse_and_compile(interpreter, &pieces);
+        }
+    }
+
+    // a loop or conditional without its done or fi
+    if (pieces.count > 0)
+    {
+        errors += parse_and_compile(interpreter, &pieces);
+    }
+    free(pieces.pieces);
+    string_buffer_free(&line);
+    fclose(fd);
+    return errors;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static bool is_initialized = false;
+
+    // parser prints its errors, they would only slow fuzzing down
+    if (!is_initialized)
+    {
+        freopen("/dev/null", "w", stdout);
+        fuzz_interpreter = minibash_new();
+        is_initialized = true;
+    }
+    if (size > FUZZ_INPUT_MAX)
+    {
+        return 0;
+    }
+
+    char *text = strndup((const char *)data, size);
+    parse_text(fuzz_interpreter, text);
+    free(text);
+    return 0;
+}
+
+#ifndef MINIBASH_LIBFUZZER
+
+// words, special characters and keywords minibash parses, random inputs are made of these
+const char *fuzz_tokens[] = {
+    "ls", "echo", "cat", "-l", "a", "file.txt", "$X", "${X}", "$?", "$1", "'a b'", "\"a $X\"", "*.c", "~/x",
+    " ", " ", " ", "\t", "\n", "|", "||", "&&", ";", "&", "+", "#", "~", "<", ">", ">>", "2>", "2>>", "2>&1",
+    "&>", "<(", ">(", "$(", "`", ")", "(", "{", "}", "<<", "<<<", "EOF", "X=1", "for i in a b; do", "done",
+    "while true; do", "until false; do", "if true; then", "elif", "else", "fi", "f() {", "}", "cd", "set",
+    "alias", "timeout 1", "retry 2", "limit cpu=1", "\x1c", "\x1d", "\x10", "%", "\\", "=", "!",
+};
+
+// runs inputs of random tokens through the parser, with a fixed seed the same inputs are made every time
+void generate_inputs(long count, unsigned int seed)
+{
+    struct string_buffer input;
+    string_buffer_init(&input);
+    srand(seed);
+
+    for (long i = 0; i < count; i++)
+    {
+        string_buffer_clear(&input);
+        int tokens = rand() % 24;
+        for (int j = 0; j < tokens; j++)
+        {
+            string_buffer_append(&input, fuzz_tokens[rand() % (sizeof(fuzz_tokens) / sizeof(fuzz_tokens[0]))]);
+        }
+        LLVMFuzzerTestOneInput((const uint8_t *)input.data, input.length);
+    }
+    string_buffer_free(&input);
+}
+
+// prints ok or error for every line of file, for comparing with what bash -n says about the same lines
+// returns -1 on error
+int print_verdicts(char *path)
+{
+    FILE *lines = fopen(path, "r");
+    if (!lines)
+    {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    // verdicts go to stdout, what parser prints goes nowhere
+    FILE *verdicts = fdopen(dup(1), "w");
+    freopen("/dev/null", "w", stdout);
+    struct minibash *interpreter = minibash_new();
+
+    struct string_buffer line;
+    string_buffer_init(&line);
+    while (string_buffer_read_line(&line, lines) != -1)
+    {
+        fprintf(verdicts, "%s\n", parse_text(interpreter, line.data) == 0 ? "ok" : "error");
+    }
+    string_buffer_free(&line);
+    minibash_free(interpreter);
+    fclose(verdicts);
+    fclose(lines);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct string_buffer input;
+    string_buffer_init(&input);
+
+    if (argc == 4 && strcmp(argv[1], "-generate") == 0)
+    {
+        generate_inputs(atol(argv[2]), atoi(argv[3]));
+        return 0;
+    }
+    if (argc == 3 && strcmp(argv[1], "-verdict") == 0)
+    {
+        return print_verdicts(argv[2]) == -1 ? 1 : 0;
+    }
+
+    for (int i = 1; i < argc || i == 1; i++)
+    {
+        int fd = argc > 1 ? open(argv[i], O_RDONLY) : 0;
+        string_buffer_clear(&input);
+        if (fd == -1 || string_buffer_read_fd(&input, fd) == -1)
+        {
+            fprintf(stderr, "%s: %s\n", argc > 1 ? argv[i] : "stdin", strerror(errno));
+            return 1;
+        }
+        LLVMFuzzerTestOneInput((const uint8_t *)input.data, input.length);
+        if (fd != 0)
+        {
+            close(fd);
+        }
+    }
+    string_buffer_free(&input);
+    return 0;
+}
+
+#endif
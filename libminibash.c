@@ -0,0 +1,8629 @@
+#define _GNU_SOURCE // for fallocate, pipe2, F_DUPFD_CLOEXEC and getdents64, mremap and memmem
+#include <stdio.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/timerfd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <termios.h>
+#include <pthread.h>
+#include <sched.h>
+#include "minibash.h"
+
+// path executable minibash in $PATH, so that it can be executed from anywhere
+
+#define MAX_ARGS 16
+#define SPECIAL_COMMANDS 21
+#define SPECIAL_CHAR 10
+#define MAX_PARAMETERS 3 // excluding the command
+#define MAX_REDIRECTIONS 8
+#define MAX_SUBSTITUTIONS 8
+#define SUBSTITUTION_MARKER '\x1d' // stands in for <(cmd) in input, followed by its index
+#define HIDDEN_CHAR_BASE '\x10'    // hidden_chars inside $(cmd) are replaced by this plus their index
+#define HERE_DOCUMENT_MARKER '\x1c' // body of every <<WORD follows input line after one of these
+#define HERE_PIPE_MAX 4096          // here documents up to this size go through a pipe, bigger ones a memfd
+#define FANOUT_CHUNK 65536
+#define RELAY_CHUNK 1048576     // most bytes one splice of pipestats relay moves
+#define SPAWN_FDS 4             // stdin, stdout, stderr and current directory of the command
+#define SPAWN_MESSAGE_MAX 65536 // bigger requests are forked by minibash itself
+#define SPAWN_NEW_CHANNEL -1    // argc of a request which only gives spawn helper a channel, as its one fd
+#define SPAWN_CHANNEL_BROKEN -2 // spawn_channel_fd once helper can't be used by interpreter
+#define DIR_CACHE_SIZE 16       // directory listings kept for glob expansion
+#define DIR_READ_SIZE 32768     // bytes read by one getdents64 call
+#define NAME_TABLE_SIZE 64      // starting number of buckets of name table, always a power of 2
+#define SHARED_PATHS_SIZE 256   // buckets of PATH lookups shared by all threads
+#define SHARED_PATHS_MAX 4096   // PATH lookups kept, all are forgotten when there'd be more
+#define FUNCTION_DEPTH_MAX 1000 // functions calling functions
+#define HISTORY_FILE ".minibash_history" // in home directory, unless HISTFILE says otherwise
+#define HISTORY_INDEX_SIZE 4096 // starting number of postings in history index, always a power of 2
+#define REGISTRY_SLOTS 256      // minibash instances one user can have registered at once
+#define WATCH_DEBOUNCE_MS 100   // changes closer together than this are one change for watch
+#define WATCH_TARGETS_MAX 8     // files and directories watch mode can watch at once
+#define TIMEOUT_GRACE_MS 1000   // after SIGTERM, a command that timed out gets this long before SIGKILL
+#define TIMEOUT_POLL_MS 10      // how often a command with a timeout is looked at without a pidfd
+#define TIMEOUT_STATUS (124 << 8) // wait status of a command that timed out, exit code 124 like timeout(1)
+#define COMMAND_NOT_FOUND 127   // exit code of a command that can't be run, like in sh
+
+// some operations of minibash
+char *custom_commands[SPECIAL_COMMANDS] = {"cd", "dter", "dtex", "addmb", "exit", "fore", "clear", "set", "export", "unset", "alias", "unalias", "hash", "history", "instances", "watch", "timeout", "retry", "limit", "pushd", "popd"};
+// below variable maps to above array
+_Thread_local int selected_custom_command = -1;
+
+// special characters of minibash
+char *special_chars[] = {
+    "#",
+    "+",
+    "<",
+    ">",
+    ">>",
+    "~",
+    ";",
+    "|",
+    "&&",
+    "||"};
+
+// below variable maps to above array
+_Thread_local int selected_special_char = -1;
+
+// number of special characters
+_Thread_local int special_char_num = 0;
+
+// boolean to find out if special characters exist or not
+_Thread_local bool is_special_char = false;
+
+_Thread_local bool is_conditional = false; // used if && or || exist
+
+_Thread_local bool is_multiple_conditional = false; // used if && || both exist in input
+
+// to hold all the conditionals if multiple_conditional is true
+// false value represents && and true value represents ||
+_Thread_local bool multiple_conditionals_sequence[] = {false, false, false};
+
+// default delimiters for tokenization in any given string
+char *default_delimiters = "\n\t\r\v\f ";
+
+// characters parser acts on, inside $(cmd) and `cmd` they are hidden until cmd runs as an input of its own
+char *hidden_chars = " #+<>~;|&";
+
+// state of the input being run is thread local, so interpreters on different threads never see each other's
+// what an interpreter keeps between inputs is in struct minibash, which is passed to every function needing it
+
+// will hold arguments to all the commands in a program
+// each is a NULL terminated array, after expansion of variables a command can have more than 4 words
+char *empty_command[] = {NULL};
+_Thread_local char **all_commands = empty_command; // used when is_special_char = true
+_Thread_local char **command_1 = empty_command;
+_Thread_local char **command_2 = empty_command;
+_Thread_local char **command_3 = empty_command;
+_Thread_local char **command_4 = empty_command;
+
+// to store all pointers in array
+_Thread_local char ***all_commands_pointer;
+
+// holds standard input's & output's file descriptor
+// both are close on exec, so that children only get 0, 1 and 2
+int stdin_fd_backup = -1, stdout_fd_backup = -1;
+pthread_once_t standard_fds_once = PTHREAD_ONCE_INIT;
+
+// names of options, in the same order as shell_option_value returns them
+char *shell_options[] = {"prealloc", "pipestats", "pipesize"};
+
+// a hop between two commands of a pipe, relayed by minibash when pipestats is on
+struct pipe_hop
+{
+    int from_fd; // read end of pipe command writes to, -1 once command closed it
+    int to_fd;   // write end of pipe next command reads from, -1 once closed
+    long long bytes;
+    double read_wait;  // seconds next command had nothing to read
+    double write_wait; // seconds command couldn't write because next command didn't read
+    bool is_full;      // last splice stopped because pipe to next command was full
+};
+
+// what pipestats reports about a command of a pipe
+struct pipe_stage
+{
+    int pid;
+    int pid_fd; // -1 once command is waited for
+    double start;
+    double end;
+    double cpu;
+};
+
+// set by timeout and limit for commands they run, every command started meanwhile gets them
+// deadline is a CLOCK_MONOTONIC time, commands still running then are killed, tv_sec 0 means no deadline
+_Thread_local struct timespec command_deadline = {0, 0};
+
+// resource limits set by limit, applied in child before exec
+struct command_limit
+{
+    char *name;
+    int resource;
+    bool is_set;
+    rlim_t value;
+};
+
+_Thread_local struct command_limit command_limits[] = {
+    {"mem", RLIMIT_AS, false, 0},
+    {"cpu", RLIMIT_CPU, false, 0},
+    {"nofile", RLIMIT_NOFILE, false, 0}};
+#define COMMAND_LIMITS (int)(sizeof(command_limits) / sizeof(command_limits[0]))
+
+// kinds of changes done to a file descriptor in child, between fork and exec
+#define FD_ACTION_OPEN 0 // open path with flags and place it on fd
+#define FD_ACTION_DUP 1  // make fd a copy of source_fd
+#define FD_ACTION_DATA 2 // fd reads path itself, for <<WORD and <<<, variables in it are expanded if flags is 1
+
+// one redirection, i.e. 2> file or 2>&1
+struct fd_action
+{
+    int kind;
+    int fd;
+    int source_fd; // for FD_ACTION_DUP
+    int flags;     // for FD_ACTION_OPEN and FD_ACTION_DATA
+    char *path;    // for FD_ACTION_OPEN, data for FD_ACTION_DATA
+    int command;   // which command of input it was written after, commands are joined by ;, |, && or ||
+};
+
+// redirections found in current input, applied in order in every child that input forks
+// for commands joined by ;, |, && or ||, select_redirections leaves only those of the command being run
+_Thread_local struct fd_action redirections[MAX_REDIRECTIONS];
+_Thread_local int redirections_num = 0;
+// where <, > or >> of input goes among redirections, it's taken out of input as a special character later
+// but is applied in the order it was written, i.e. for ls 2>&1 > file stderr stays where stdout was
+_Thread_local int redirection_position = 0;
+
+// one process substitution, <(cmd) or >(cmd)
+struct process_substitution
+{
+    char *command;  // input inside the brackets, run by a child minibash
+    bool is_output; // true for >(cmd), command reads what is written to /dev/fd/N
+    int fd;         // minibash's end of the pipe, passed to commands as /dev/fd/N
+    int pid;
+};
+
+// process substitutions found in current input
+_Thread_local struct process_substitution substitutions[MAX_SUBSTITUTIONS];
+_Thread_local int substitutions_num = 0;
+
+// spawn helper, a small process forked at start which forks and execs commands for minibash
+// socket connected to spawn helper, only used to give it channels, -1 when minibash forks commands itself
+int spawn_helper_fd = -1;
+// pid of minibash that started the helper, forked copies of minibash don't use it
+int spawn_helper_owner = -1;
+// id of last request this thread sent to spawn helper
+_Thread_local unsigned int spawn_request_id = 0;
+
+// request sent to spawn helper, followed by path to run, argc arguments and envc environment changes,
+// each null terminated, environment changes are NAME=value to set and NAME to unset
+struct spawn_request
+{
+    unsigned int id;
+    int argc;
+    int envc;
+};
+
+// reply from spawn helper, sent once when command is started and once when it's done
+struct spawn_reply
+{
+    unsigned int id;
+    int pid;
+    int status;
+    bool exited;
+};
+
+// a command spawn helper started, its exit status is sent back on channel it was asked for on
+struct spawned_command
+{
+    int pid;
+    int channel_fd; // -1 once channel is closed
+    unsigned int id;
+};
+
+// a shell variable, exported ones are passed to commands in their environment
+struct variable
+{
+    char *name;
+    char *value;   // NULL once unset
+    bool exported;
+    bool changed;  // differs from environment minibash started with
+};
+
+// minibash -c with a single simple command, nothing runs after it so minibash execs it instead of forking
+_Thread_local bool is_exec_in_place = false;
+
+// versions of current directories of interpreters, no two directories of any interpreters have the same one
+unsigned long cwd_versions = 0;
+// cwd_version of directory this thread is in, it only changes directory when it's in a different one
+_Thread_local unsigned long thread_cwd_version = 0;
+// true once this thread has a current directory of its own, unshare is only tried once by a thread
+_Thread_local bool is_cwd_private = false;
+_Thread_local bool is_cwd_unshare_tried = false;
+// directory thread was in before an interpreter changed it, it goes back there when interpreter is left,
+// -1 if thread is in its own directory
+_Thread_local int thread_saved_cwd_fd = -1;
+_Thread_local unsigned long thread_saved_cwd_version = 0;
+
+// a directory cd - or popd can go back to, kept open so going back needs no lookup of its path
+struct directory
+{
+    int fd;     // O_PATH fd
+    char *path; // logical path, NULL if it isn't known
+};
+
+// growable NULL terminated list of words
+struct word_list
+{
+    char **words;
+    int count;
+    int capacity;
+};
+
+// one entry of a cached directory listing
+struct dir_entry
+{
+    size_t name_offset; // into names of its listing
+    unsigned char type; // DT_* as given by getdents64
+};
+
+// entries of a directory sorted by name, used for glob expansion
+// a listing is reused for as long as inode and mtime of its directory stay the same
+struct dir_listing
+{
+    dev_t device;
+    ino_t inode;
+    struct timespec mtime;
+    char *names; // all names, each null terminated
+    struct dir_entry *entries;
+    int entries_num;
+    unsigned long last_used;
+};
+
+_Thread_local struct dir_listing dir_cache[DIR_CACHE_SIZE];
+_Thread_local int dir_cache_num = 0;
+_Thread_local unsigned long dir_cache_clock = 0;
+// dir_cache of a thread is freed by destructor of this key when the thread exits
+pthread_key_t dir_cache_key;
+pthread_once_t dir_cache_once = PTHREAD_ONCE_INIT;
+
+// growable string with an explicit length, used for input lines and paths
+// data is always null terminated, length never counts the null character
+struct string_buffer
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+};
+
+// keywords of loops and conditionals, below KEYWORD_* map to this array
+#define KEYWORDS 12
+#define KEYWORD_NONE -1
+#define KEYWORD_FOR 0
+#define KEYWORD_WHILE 1
+#define KEYWORD_UNTIL 2
+#define KEYWORD_IF 3
+#define KEYWORD_ELIF 4
+#define KEYWORD_THEN 5
+#define KEYWORD_ELSE 6
+#define KEYWORD_FI 7
+#define KEYWORD_DO 8
+#define KEYWORD_DONE 9
+#define KEYWORD_OPEN_BRACE 10
+#define KEYWORD_CLOSE_BRACE 11
+#define KEYWORD_FUNCTION 12 // NAME(), found by function_name_length, not in below array
+char *keywords[KEYWORDS] = {"for", "while", "until", "if", "elif", "then", "else", "fi", "do", "done", "{", "}"};
+
+// a keyword with what follows it, or a command when keyword is KEYWORD_NONE
+struct script_piece
+{
+    int keyword;
+    char *text;
+};
+
+// pieces of lines read so far, depth is number of loops and conditionals still open
+struct script_pieces
+{
+    struct script_piece *pieces;
+    int count;
+    int capacity;
+    int depth;
+};
+
+// what parsing an input leaves behind, kept so the input can be run again without parsing it again
+// words are kept as typed, variables and globs in them are expanded on every run
+struct command_plan
+{
+    int state;   // what compile_plan returned, 1 ready, 0 empty input, -1 invalid input
+    char *input; // input after parsing, as perform_commands takes it
+    int selected_special_char;
+    int special_char_num;
+    bool is_special_char;
+    bool is_conditional;
+    bool is_multiple_conditional;
+    bool multiple_conditionals_sequence[3];
+    char **commands[4];
+    struct fd_action redirections[MAX_REDIRECTIONS];
+    int redirections_num;
+    int redirection_position;
+    struct process_substitution substitutions[MAX_SUBSTITUTIONS];
+    int substitutions_num;
+};
+
+// everything about the input being run, put aside while a function runs inputs of its own
+struct input_state
+{
+    int selected_special_char;
+    int special_char_num;
+    bool is_special_char;
+    bool is_conditional;
+    bool is_multiple_conditional;
+    bool multiple_conditionals_sequence[3];
+    int selected_custom_command;
+    char **commands[4];
+    char **all_commands;
+    char ***all_commands_pointer;
+    struct fd_action redirections[MAX_REDIRECTIONS];
+    int redirections_num;
+    int redirection_position;
+    struct process_substitution substitutions[MAX_SUBSTITUTIONS];
+    int substitutions_num;
+};
+
+// kinds of statements
+#define STATEMENT_COMMAND 0 // an input line, run the same way as at the prompt
+#define STATEMENT_FOR 1
+#define STATEMENT_WHILE 2
+#define STATEMENT_UNTIL 3
+#define STATEMENT_IF 4
+#define STATEMENT_FUNCTION 5 // defines a function when run
+
+struct statement;
+
+struct statement_list
+{
+    struct statement *statements;
+    int count;
+    int capacity;
+};
+
+// a function, its body is parsed once where it's defined and shared by every call
+// it's freed once neither its definition nor name table nor a running call refer to it
+struct function
+{
+    struct statement_list body;
+    int references;
+};
+
+// a name minibash knows, every name has one entry, so it's looked up once for all of its meanings
+struct name_entry
+{
+    char *name;
+    unsigned int hash;
+    int builtin;               // index into custom_commands, -1 if name isn't a builtin
+    struct function *function; // NULL if name isn't a function
+    char *alias;               // NULL if name isn't an alias
+    char *path;                // where name was found in PATH, NULL until it's looked up
+    struct name_entry *next;
+};
+
+// an interpreter, what it keeps between inputs, every function that needs it is passed it
+// only one thread at a time may use an interpreter, parsing state is left empty after every input, so it isn't kept
+struct minibash
+{
+    struct variable *variables;
+    int variables_num;
+    int variables_capacity;
+    // environment passed to commands, NAME=value of all exported variables
+    // it's built again only when an exported variable changes, not for every command
+    char **environment_cache;
+    // changes of environment since start, NAME=value or NAME to unset, sent to spawn helper
+    char **environment_delta_cache;
+    bool environment_changed;
+    // hash table of names, buckets is always a power of 2
+    struct name_entry **name_table;
+    int name_table_buckets;
+    int name_table_count;
+    int aliases_num;
+    // to keep track of background process ids
+    int *background_processes_pids;
+    // options of minibash, changed with set name=value
+    // size hint in bytes for files written by >, 2> and &>, 0 means don't preallocate
+    long long prealloc_size;
+    // when on, output of commands of a pipe goes through minibash, which reports throughput of every command
+    long long pipestats;
+    // capacity in bytes of every pipe minibash makes, 0 keeps size given by kernel
+    long long pipe_size;
+    // exit code of last input, for $?
+    int last_exit_status;
+    // set by exit, loops, scripts and the prompt stop once it is
+    bool is_exit_requested;
+    // current directory of interpreter, an O_PATH fd, -1 if it couldn't be opened
+    // every thread has a current directory of its own, it's changed to this one when interpreter is entered
+    int cwd_fd;
+    // changes whenever cwd_fd does, taken from cwd_versions
+    unsigned long cwd_version;
+    // logical path of current directory, symlinks cd went through are kept in it, NULL until it's needed
+    char *cwd_path;
+    // directory before the last change of directory, for cd -
+    struct directory previous_directory;
+    // directories pushd has put aside, top is last
+    struct directory *directory_stack;
+    int directory_stack_num;
+    int directory_stack_capacity;
+    // $HOME, or /home/$USER without it, worked out once and again only after HOME changes
+    char *home_path;
+    // every interpreter sends commands over a channel of its own, opened when it first runs one, so helper runs
+    // commands of interpreters on different threads at the same time and replies never go to the wrong one
+    // -1 until opened, SPAWN_CHANNEL_BROKEN once helper can't be used
+    int spawn_channel_fd;
+};
+
+// interpreter this thread is in, NULL when there's none, only for signal handlers, which can't be passed it
+_Thread_local struct minibash *current_interpreter = NULL;
+
+// where commands were found in PATH by interpreters of any thread, a lookup is for a name and a PATH
+// names' entries in name table are looked up here before PATH is searched
+struct shared_path
+{
+    char *name;
+    char *directories; // PATH name was searched in
+    char *path;
+    struct shared_path *next;
+};
+
+struct shared_path *shared_paths[SHARED_PATHS_SIZE];
+int shared_paths_num = 0;
+// also held while index of PATH executables is used, it's shared by all threads too
+pthread_mutex_t shared_paths_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// arguments of function being run, for $1 to $9 and $@
+_Thread_local char **positional_parameters = empty_command;
+_Thread_local int function_depth = 0;
+
+// a statement of a script, loops and conditionals hold lists of statements
+struct statement
+{
+    int kind;
+    char *text;                  // input of STATEMENT_COMMAND
+    struct command_plan *plan;   // compiled from text when statement first runs
+    char *name;                  // variable of for, name of function
+    char **words;                // words of for, expanded every time loop starts
+    struct function *function;   // body of function
+    struct statement_list condition;
+    struct statement_list body;      // of loops, and of if when condition holds
+    struct statement_list else_body; // elif is an if inside else_body
+};
+
+// history, an append only file shared by all minibash instances of a user
+// nothing is read at start, file is mapped and indexed the first time history is used,
+// after that only lines other instances or this one have appended since are indexed
+int history_fd = -1;
+char *history_map = NULL;
+size_t history_map_size = 0;
+size_t history_indexed = 0; // bytes of mapping that are indexed, always ends after a new line
+size_t *history_lines = NULL; // offset of every line in mapping
+int history_lines_num = 0;
+int history_lines_capacity = 0;
+// history is shared by interpreters of all threads, mapping and index are only used while it's held
+pthread_mutex_t history_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// lines of history that have a trigram, or that start with 1 or 2 bytes, in ascending order
+// a search only looks at lines of the rarest trigram of its query instead of at every line
+struct history_postings
+{
+    unsigned int key; // from history_key, 0 if unused
+    int *lines;
+    int lines_num;
+    int lines_capacity;
+};
+
+// hash table of postings with open addressing, capacity is always a power of 2
+struct history_postings *history_index = NULL;
+int history_index_capacity = 0;
+int history_index_used = 0;
+
+// executables of a directory of PATH, for completion of command names
+// filtered from a listing of the directory, which is read again only when mtime of directory changes
+struct path_directory
+{
+    char *path;
+    struct dir_listing listing; // only entries which are executable files
+    bool is_read;
+};
+
+// index of executables of every directory of PATH, rebuilt when PATH changes, only used with shared_paths_lock held
+struct path_directory *path_index = NULL;
+int path_index_num = 0;
+char *path_index_value = NULL; // PATH the index was made for
+
+// registry of running minibash instances of a user, a shared memory object with a pid for every slot
+// an instance holds a lock on the byte of its slot for as long as it lives, so a slot whose lock
+// isn't held is free, even if its instance was killed without getting to clear its pid
+int registry_fd = -1;
+pid_t *registry = NULL;
+int registry_slot = -1;
+// true in the minibash program, which registers itself, dter and dtex only kill processes then,
+// a program embedding interpreters isn't ended by a command
+bool is_program = false;
+
+// a file or directory watched for changes, files are watched through their directory,
+// so that editors replacing a file with a new one are noticed too
+struct watch_target
+{
+    int descriptor; // inotify watch descriptor of directory
+    char *name;     // name of file in directory, NULL to watch whole directory
+    bool is_changed;
+};
+
+volatile sig_atomic_t is_watch_interrupted = 0;
+
+// keys of line editor which aren't characters
+#define KEY_UP 1000
+#define KEY_DOWN 1001
+#define KEY_RIGHT 1002
+#define KEY_LEFT 1003
+#define KEY_HOME 1004
+#define KEY_END 1005
+#define KEY_DELETE 1006
+#define KEY_UNKNOWN 1007
+
+// define some functions
+int fork_and_run(struct minibash *interpreter, char *command[], char *input);
+void minibash(struct minibash *interpreter, char *input_from_script);
+void free_command(char **command);
+char **copy_command(char **command);
+void clear_path_cache(struct minibash *interpreter);
+int run_statements(struct minibash *interpreter, struct statement_list *list);
+void free_statements(struct statement_list *list);
+void reset();
+int write_all(int fd, char *buffer, size_t length);
+int watch_command(struct minibash *interpreter, char *command[]);
+int exit_code(int status);
+void glob_word(char *word, struct word_list *list);
+int find_size(struct minibash *interpreter);
+int get_index_and_shift(struct minibash *interpreter, int pid);
+int get_index(struct minibash *interpreter, int pid);
+int check_all_commands_exist(char *custom_message);
+
+// STRING BUFFER
+// initialize an empty string buffer, nothing is allocated until something is appended
+void string_buffer_init(struct string_buffer *buffer)
+{
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+// make sure buffer can hold at least extra more bytes plus the null character
+// capacity grows geometrically so that appending n bytes one by one stays linear
+// exits program if memory can't be allocated
+void string_buffer_reserve(struct string_buffer *buffer, size_t extra)
+{
+    size_t required = buffer->length + extra + 1;
+
+    if (required <= buffer->capacity)
+    {
+        return;
+    }
+
+    size_t capacity = buffer->capacity ? buffer->capacity : 64;
+    while (capacity < required)
+    {
+        capacity *= 2;
+    }
+
+    char *data = realloc(buffer->data, capacity);
+    if (!data)
+    {
+        fprintf(stderr, "minibash: out of memory\n");
+        exit(-1);
+    }
+
+    buffer->data = data;
+    buffer->capacity = capacity;
+}
+
+// append length bytes of string to buffer
+void string_buffer_append_length(struct string_buffer *buffer, const char *string, size_t length)
+{
+    string_buffer_reserve(buffer, length);
+    memcpy(buffer->data + buffer->length, string, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+}
+
+// append a null terminated string to buffer
+void string_buffer_append(struct string_buffer *buffer, const char *string)
+{
+    string_buffer_append_length(buffer, string, strlen(string));
+}
+
+// append a single character to buffer
+void string_buffer_append_char(struct string_buffer *buffer, char c)
+{
+    string_buffer_reserve(buffer, 1);
+    buffer->data[buffer->length++] = c;
+    buffer->data[buffer->length] = '\0';
+}
+
+// insert length bytes of string at position of buffer
+void string_buffer_insert(struct string_buffer *buffer, size_t position, const char *string, size_t length)
+{
+    string_buffer_reserve(buffer, length);
+    memmove(buffer->data + position + length, buffer->data + position, buffer->length - position + 1);
+    memcpy(buffer->data + position, string, length);
+    buffer->length += length;
+}
+
+// remove length bytes of buffer from position
+void string_buffer_erase(struct string_buffer *buffer, size_t position, size_t length)
+{
+    memmove(buffer->data + position, buffer->data + position + length, buffer->length - position - length + 1);
+    buffer->length -= length;
+}
+
+// empty the buffer but keep the memory for reuse
+void string_buffer_clear(struct string_buffer *buffer)
+{
+    buffer->length = 0;
+    if (buffer->data)
+    {
+        buffer->data[0] = '\0';
+    }
+}
+
+// release memory held by buffer
+void string_buffer_free(struct string_buffer *buffer)
+{
+    free(buffer->data);
+    string_buffer_init(buffer);
+}
+
+// reads a complete line from file into buffer, replacing what buffer had
+// trailing new line character is removed
+// returns length of line, returns -1 on EOF or error
+long string_buffer_read_line(struct string_buffer *buffer, FILE *file)
+{
+    ssize_t line_length = getline(&buffer->data, &buffer->capacity, file);
+
+    if (line_length == -1)
+    {
+        string_buffer_clear(buffer);
+        return -1;
+    }
+
+    if (line_length > 0 && buffer->data[line_length - 1] == '\n')
+    {
+        buffer->data[--line_length] = '\0';
+    }
+
+    buffer->length = line_length;
+    return line_length;
+}
+
+// reads everything from fd till EOF and appends it to buffer
+// returns number of bytes read, returns -1 on error
+long string_buffer_read_fd(struct string_buffer *buffer, int fd)
+{
+    size_t start = buffer->length;
+
+    while (true)
+    {
+        string_buffer_reserve(buffer, 4096);
+
+        ssize_t bytes_read = read(fd, buffer->data + buffer->length, buffer->capacity - buffer->length - 1);
+        if (bytes_read == 0)
+        {
+            break;
+        }
+        if (bytes_read == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes_read == -1)
+        {
+            return -1;
+        }
+        buffer->length += bytes_read;
+    }
+
+    buffer->data[buffer->length] = '\0';
+    return buffer->length - start;
+}
+
+// stores current working directory in buffer, growing it till the path fits
+// returns 1 on success, returns -1 on error
+int get_current_directory(struct string_buffer *buffer)
+{
+    string_buffer_clear(buffer);
+    string_buffer_reserve(buffer, 255);
+
+    while (getcwd(buffer->data, buffer->capacity) == NULL)
+    {
+        if (errno != ERANGE)
+        {
+            return -1;
+        }
+        string_buffer_reserve(buffer, buffer->capacity);
+    }
+
+    buffer->length = strlen(buffer->data);
+    return 1;
+}
+
+// SOME UTILITES
+// makes a pipe like pipe2, every pipe minibash makes is made here so that pipesize applies to all of them
+// a bigger pipe lets commands move more data per context switch
+// returns -1 on error
+int make_pipe(struct minibash *interpreter, int fd[2], int flags)
+{
+    if (pipe2(fd, flags) == -1)
+    {
+        return -1;
+    }
+    // size above /proc/sys/fs/pipe-max-size isn't allowed to normal users, pipe then keeps its size
+    if (interpreter->pipe_size > 0)
+    {
+        fcntl(fd[1], F_SETPIPE_SZ, (int)(interpreter->pipe_size < INT_MAX ? interpreter->pipe_size : INT_MAX));
+    }
+    return 0;
+}
+
+void duplicate_standard_fds()
+{
+    stdin_fd_backup = fcntl(0, F_DUPFD_CLOEXEC, 0);
+    stdout_fd_backup = fcntl(1, F_DUPFD_CLOEXEC, 0);
+}
+
+// stdin and stdout of minibash are duplicated the first time a command needs them, not at startup
+// only once for all threads
+// returns -1 on error
+int backup_standard_fds()
+{
+    pthread_once(&standard_fds_once, duplicate_standard_fds);
+    return stdout_fd_backup == -1 ? -1 : 0;
+}
+
+// kill all background processes
+void kill_all_background_processes(struct minibash *interpreter)
+{
+    int size = find_size(interpreter);
+
+    // loop and kill all background processes
+    for (int i = 0; i < size; i++)
+    {
+        kill(interpreter->background_processes_pids[i], SIGKILL);
+    }
+}
+
+// after each iteration or error case, reset things
+void reset()
+{
+    fflush(stdin);
+    free_command(command_1);
+    free_command(command_2);
+    free_command(command_3);
+    free_command(command_4);
+    free_command(all_commands);
+    command_1 = empty_command;
+    command_2 = empty_command;
+    command_3 = empty_command;
+    command_4 = empty_command;
+    all_commands = empty_command;
+    free(all_commands_pointer);
+    all_commands_pointer = NULL;
+
+    // forget redirections of this input
+    for (int i = 0; i < redirections_num; i++)
+    {
+        free(redirections[i].path);
+    }
+    redirections_num = 0;
+    redirection_position = 0;
+
+    for (int i = 0; i < substitutions_num; i++)
+    {
+        free(substitutions[i].command);
+    }
+    substitutions_num = 0;
+}
+
+// handle SIGCONT, used in send_to_background in child to connect input to stdin when fore is called
+void handle_sigcont()
+{
+    dup2(stdin_fd_backup, 0); // redirect input back to stdin
+}
+
+// reaps background processes of interpreter that are done and prints that they are
+// called between commands instead of from a SIGCHLD handler, so a program embedding interpreters keeps its own
+// handler and nothing is printed from inside a signal handler
+// only background processes are reaped here, foreground ones are waited for by whoever started them
+void reap_background_processes(struct minibash *interpreter)
+{
+    int pid;
+    int status;
+    int i = 0;
+
+    // loop to get all sigchld if all exit at the same time
+    while (interpreter->background_processes_pids && interpreter->background_processes_pids[i] != -1)
+    {
+        pid = interpreter->background_processes_pids[i];
+        if (waitpid(pid, &status, WNOHANG) <= 0)
+        {
+            i++;
+            continue;
+        }
+
+        if (WIFEXITED(status))
+        {
+            if (WEXITSTATUS(status) == COMMAND_NOT_FOUND)
+            {
+                printf("minibash: command not found\n");
+            }
+            else if (get_index(interpreter, pid) != -1)
+            {
+                printf("Background Process [%d]+ with pid %d is done.\n", get_index_and_shift(interpreter, pid), pid);
+            }
+        }
+        else if (WIFSIGNALED(status))
+        {
+            printf("Background Process %d Exited with Signal Number:%d\n", pid, WTERMSIG(status));
+        }
+
+        // remove it, if it's still there, next pid has moved to index i
+        if (get_index(interpreter, pid) != -1)
+        {
+            get_index_and_shift(interpreter, pid);
+        }
+    }
+}
+
+// kills all background processes of interpreter, if there's one, leaves registry and exits with status
+void leave_minibash(struct minibash *interpreter, int status)
+{
+    if (interpreter)
+    {
+        kill_all_background_processes(interpreter);
+    }
+    if (registry_slot != -1)
+    {
+        registry[registry_slot] = 0;
+    }
+    exit(status);
+}
+
+// handle sigint
+// kills all background processes
+void handle_sigint()
+{
+    leave_minibash(current_interpreter, 0);
+}
+
+// VARIABLES
+// growable list of words, ends with NULL once finished
+void word_list_init(struct word_list *list)
+{
+    list->words = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+// adds word to list, list takes ownership of word
+void word_list_push(struct word_list *list, char *word)
+{
+    // +1 so there's always space for NULL at the end
+    if (list->count + 1 >= list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 8;
+        list->words = realloc(list->words, sizeof(char *) * list->capacity);
+        if (!list->words)
+        {
+            fprintf(stderr, "minibash: out of memory\n");
+            exit(-1);
+        }
+    }
+    list->words[list->count++] = word;
+    list->words[list->count] = NULL;
+}
+
+// returns NULL terminated array of words, which belongs to caller
+char **word_list_finish(struct word_list *list)
+{
+    if (list->words == NULL)
+    {
+        word_list_push(list, NULL);
+        list->count = 0;
+    }
+    return list->words;
+}
+
+// frees words of a NULL terminated array and the array itself
+void free_command(char **command)
+{
+    if (command == NULL || command == empty_command)
+    {
+        return;
+    }
+    for (int i = 0; command[i] != NULL; i++)
+    {
+        free(command[i]);
+    }
+    free(command);
+}
+
+// returns a copy of command, which can be freed with free_command
+char **copy_command(char **command)
+{
+    if (command == empty_command)
+    {
+        return empty_command;
+    }
+
+    struct word_list list;
+    word_list_init(&list);
+    for (int i = 0; command[i] != NULL; i++)
+    {
+        word_list_push(&list, strdup(command[i]));
+    }
+    return word_list_finish(&list);
+}
+
+// returns true if character can be part of a variable name
+bool is_name_char(char c, bool first)
+{
+    return c == '_' || isalpha((unsigned char)c) || (!first && isdigit((unsigned char)c));
+}
+
+// returns length of NAME if word starts with NAME=, otherwise 0
+int assignment_name_length(char *word)
+{
+    int i = 0;
+    while (is_name_char(word[i], i == 0))
+    {
+        i++;
+    }
+    return (i > 0 && word[i] == '=') ? i : 0;
+}
+
+// loads environment minibash was started with into variables, done once on first use
+void init_variables(struct minibash *interpreter)
+{
+    if (interpreter->variables != NULL)
+    {
+        return;
+    }
+
+    interpreter->variables_capacity = 64;
+    interpreter->variables = malloc(sizeof(struct variable) * interpreter->variables_capacity);
+
+    for (char **env = environ; *env != NULL; env++)
+    {
+        char *equals = strchr(*env, '=');
+        if (!equals)
+        {
+            continue;
+        }
+        if (interpreter->variables_num == interpreter->variables_capacity)
+        {
+            interpreter->variables_capacity *= 2;
+            interpreter->variables =
+                realloc(interpreter->variables, sizeof(struct variable) * interpreter->variables_capacity);
+        }
+        interpreter->variables[interpreter->variables_num].name = strndup(*env, equals - *env);
+        interpreter->variables[interpreter->variables_num].value = strdup(equals + 1);
+        interpreter->variables[interpreter->variables_num].exported = true;
+        interpreter->variables[interpreter->variables_num].changed = false;
+        interpreter->variables_num++;
+    }
+}
+
+// returns variable with name of given length, NULL if it doesn't exist
+struct variable *find_variable(struct minibash *interpreter, const char *name, size_t length)
+{
+    init_variables(interpreter);
+
+    for (int i = 0; i < interpreter->variables_num; i++)
+    {
+        char *variable_name = interpreter->variables[i].name;
+        if (strncmp(variable_name, name, length) == 0 && variable_name[length] == '\0')
+        {
+            return &interpreter->variables[i];
+        }
+    }
+    return NULL;
+}
+
+// returns value of variable, NULL if it isn't set
+char *get_variable(struct minibash *interpreter, const char *name)
+{
+    struct variable *variable = find_variable(interpreter, name, strlen(name));
+    return variable ? variable->value : NULL;
+}
+
+// sets value of a variable, creating it if needed, value is copied
+// value NULL unsets variable, export true marks it to be passed to commands
+void set_variable(struct minibash *interpreter, const char *name, size_t length, const char *value, bool export)
+{
+    struct variable *variable = find_variable(interpreter, name, length);
+
+    if (!variable)
+    {
+        if (value == NULL)
+        {
+            return;
+        }
+        if (interpreter->variables_num == interpreter->variables_capacity)
+        {
+            interpreter->variables_capacity *= 2;
+            interpreter->variables =
+                realloc(interpreter->variables, sizeof(struct variable) * interpreter->variables_capacity);
+        }
+        variable = &interpreter->variables[interpreter->variables_num++];
+        variable->name = strndup(name, length);
+        variable->value = NULL;
+        variable->exported = false;
+        variable->changed = false;
+    }
+
+    // commands are looked up in PATH again once it changes
+    if (strcmp(variable->name, "PATH") == 0)
+    {
+        clear_path_cache(interpreter);
+    }
+    else if (strcmp(variable->name, "HOME") == 0)
+    {
+        free(interpreter->home_path);
+        interpreter->home_path = NULL;
+    }
+
+    // only changes to exported variables change environment of commands
+    if (variable->exported || export)
+    {
+        interpreter->environment_changed = true;
+        variable->changed = true;
+    }
+
+    // value may be variable's own value, so copy it before freeing
+    char *copy = value ? strdup(value) : NULL;
+    free(variable->value);
+    variable->value = copy;
+    if (value == NULL)
+    {
+        variable->exported = false;
+    }
+    else if (export)
+    {
+        variable->exported = true;
+    }
+}
+
+// returns environment for commands, NAME=value of every exported variable
+// array is cached and only built again after an exported variable has changed
+char **get_environment(struct minibash *interpreter)
+{
+    init_variables(interpreter);
+
+    if (!interpreter->environment_changed)
+    {
+        return interpreter->environment_cache;
+    }
+
+    free_command(interpreter->environment_cache);
+    free_command(interpreter->environment_delta_cache);
+
+    struct word_list environment, delta;
+    word_list_init(&environment);
+    word_list_init(&delta);
+
+    for (int i = 0; i < interpreter->variables_num; i++)
+    {
+        struct variable *variable = &interpreter->variables[i];
+        struct string_buffer entry;
+
+        if (!variable->exported && !variable->changed)
+        {
+            continue;
+        }
+
+        string_buffer_init(&entry);
+        string_buffer_append(&entry, variable->name);
+        if (variable->exported && variable->value)
+        {
+            string_buffer_append_char(&entry, '=');
+            string_buffer_append(&entry, variable->value);
+            word_list_push(&environment, strdup(entry.data));
+        }
+
+        // spawn helper was started with the original environment, it only needs what changed
+        if (variable->changed)
+        {
+            word_list_push(&delta, strdup(entry.data));
+        }
+        string_buffer_free(&entry);
+    }
+
+    interpreter->environment_cache = word_list_finish(&environment);
+    interpreter->environment_delta_cache = word_list_finish(&delta);
+    interpreter->environment_changed = false;
+    return interpreter->environment_cache;
+}
+
+// returns environment for command, which starts with assignments_num NAME=value words
+// without assignments cached environment is returned, otherwise a new array with them added
+char **command_environment(struct minibash *interpreter, char **command, int assignments_num)
+{
+    char **environment = get_environment(interpreter);
+
+    if (assignments_num == 0)
+    {
+        return environment;
+    }
+
+    struct word_list list;
+    word_list_init(&list);
+    for (int i = 0; i < assignments_num; i++)
+    {
+        word_list_push(&list, command[i]);
+    }
+    for (int i = 0; environment[i] != NULL; i++)
+    {
+        // skip ones which are overridden by assignments
+        int j = 0;
+        while (j < assignments_num && strncmp(environment[i], command[j], assignment_name_length(command[j]) + 1) != 0)
+        {
+            j++;
+        }
+        if (j == assignments_num)
+        {
+            word_list_push(&list, environment[i]);
+        }
+    }
+    return word_list_finish(&list);
+}
+
+// returns number of NAME=value words at the start of command
+int count_assignments(char **command)
+{
+    int i = 0;
+    while (command[i] != NULL && assignment_name_length(command[i]) > 0)
+    {
+        i++;
+    }
+    return i;
+}
+
+// for NAME=value without a command, sets shell variables
+void assign_variables(struct minibash *interpreter, char **command, int assignments_num)
+{
+    for (int i = 0; i < assignments_num; i++)
+    {
+        int length = assignment_name_length(command[i]);
+        set_variable(interpreter, command[i], length, command[i] + length + 1, false);
+    }
+}
+
+// adds words to list, splitting value on whitespaces
+// first part is appended to word being built, last part is left in it
+// runs of characters are copied at once, so splitting a big output copies every byte only once
+void split_into_words(struct word_list *list, struct string_buffer *word, bool *has_word, const char *value)
+{
+    for (const char *c = value; *c != '\0';)
+    {
+        size_t run = strcspn(c, " \t\n");
+        if (run > 0)
+        {
+            string_buffer_append_length(word, c, run);
+            *has_word = true;
+            c += run;
+        }
+        if (*c != '\0')
+        {
+            if (*has_word)
+            {
+                word_list_push(list, strdup(word->data));
+                string_buffer_clear(word);
+                *has_word = false;
+            }
+            c += strspn(c, " \t\n");
+        }
+    }
+}
+
+// returns end of $(cmd) or `cmd` starting at start, the character after ) or `
+// returns NULL if it isn't closed
+char *command_substitution_end(char *start)
+{
+    if (*start == '`')
+    {
+        char *end = strchr(start + 1, '`');
+        return end ? end + 1 : NULL;
+    }
+
+    int depth = 1;
+    for (char *c = start + 2; *c != '\0'; c++)
+    {
+        depth += (*c == '(') - (*c == ')');
+        if (depth == 0)
+        {
+            return c + 1;
+        }
+    }
+    return NULL;
+}
+
+// hides characters parser acts on inside every $(cmd) and `cmd` of input,
+// so that cmd stays in one word, whatever special characters and spaces it has
+// returns -1 on error
+int hide_command_substitutions(char *input)
+{
+    for (char *c = input; *c != '\0'; c++)
+    {
+        if (*c != '`' && !(*c == '$' && c[1] == '('))
+        {
+            continue;
+        }
+
+        char *end = command_substitution_end(c);
+        if (!end)
+        {
+            printf("Syntax Error, missing '%s' after '%s'\n", *c == '`' ? "`" : ")", *c == '`' ? "`" : "$(");
+            return -1;
+        }
+        for (c++; c < end - 1; c++)
+        {
+            char *hidden = *c ? strchr(hidden_chars, *c) : NULL;
+            if (hidden)
+            {
+                *c = HIDDEN_CHAR_BASE + (hidden - hidden_chars);
+            }
+        }
+    }
+    return 1;
+}
+
+// runs command as an input of its own and puts what it prints in output, without its trailing new lines
+// output is read straight into buffer, which grows geometrically, so big outputs are copied only once
+// returns exit status of command
+int capture_command(struct minibash *interpreter, char *command, size_t length, struct string_buffer *output)
+{
+    int fd[2];
+    int status = 0;
+
+    // characters hidden from parser are given back, command is parsed when it runs
+    char *text = strndup(command, length);
+    for (char *c = text; *c != '\0'; c++)
+    {
+        if (*c >= HIDDEN_CHAR_BASE && *c < HIDDEN_CHAR_BASE + (int)strlen(hidden_chars))
+        {
+            *c = hidden_chars[*c - HIDDEN_CHAR_BASE];
+        }
+    }
+
+    if (make_pipe(interpreter, fd, O_CLOEXEC) == -1)
+    {
+        printf("Pipe Failed\n");
+        free(text);
+        return 1;
+    }
+
+    fflush(stdout); // so child doesn't print what's still buffered in minibash
+    int child_pid = fork();
+    if (child_pid == 0)
+    {
+        // child process, like a process substitution
+        dup2(fd[1], 1);
+        close(fd[0]);
+        close(fd[1]);
+        // last command of a pipe writes to stdout of minibash, which is the pipe here
+        // if it wasn't backed up yet, the backup taken later is the pipe anyway
+        if (stdout_fd_backup != -1)
+        {
+            dup3(1, stdout_fd_backup, O_CLOEXEC);
+        }
+        reset();
+        minibash(interpreter, text);
+        fflush(stdout);
+        _exit(interpreter->last_exit_status);
+    }
+    close(fd[1]);
+    free(text);
+    if (child_pid == -1)
+    {
+        printf("Fork Failed\n");
+        close(fd[0]);
+        return 1;
+    }
+
+    string_buffer_read_fd(output, fd[0]);
+    close(fd[0]);
+    while (waitpid(child_pid, &status, 0) == -1 && errno == EINTR)
+        ;
+
+    while (output->length > 0 && output->data[output->length - 1] == '\n')
+    {
+        output->length--;
+    }
+    if (output->data)
+    {
+        output->data[output->length] = '\0';
+    }
+    return exit_code(status);
+}
+
+// expands $NAME, ${NAME}, $? and $$ in word and adds result to list
+// if split is true, values are split into more words on whitespaces and a word that expands
+// to nothing is dropped, like in bash when there are no quotes
+void expand_word(struct minibash *interpreter, char *word, struct word_list *list, bool split)
+{
+    struct string_buffer result, arguments, output;
+    string_buffer_init(&result);
+    string_buffer_init(&arguments);
+    string_buffer_init(&output);
+    string_buffer_append(&result, ""); // so result.data is never NULL
+    bool has_word = false;
+
+    for (char *c = word; *c != '\0'; c++)
+    {
+        char *name = NULL;
+        size_t length = 0;
+        char number[16];
+        char *value = NULL;
+
+        if (*c == '$' && c[1] == '{')
+        {
+            char *end = strchr(c + 2, '}');
+            if (end)
+            {
+                name = c + 2;
+                length = end - name;
+                c = end;
+            }
+        }
+        else if (*c == '$' && is_name_char(c[1], true))
+        {
+            name = c + 1;
+            while (is_name_char(name[length], length == 0))
+            {
+                length++;
+            }
+            c += length;
+        }
+        else if (*c == '$' && (c[1] == '?' || c[1] == '$'))
+        {
+            snprintf(number, sizeof(number), "%d", c[1] == '?' ? interpreter->last_exit_status : getpid());
+            value = number;
+            c++;
+        }
+        else if (*c == '$' && (c[1] == '@' || c[1] == '*' || (c[1] >= '1' && c[1] <= '9')))
+        {
+            // arguments of function being run, $# can't be one as # is a special character
+            int count = 0;
+            while (positional_parameters[count] != NULL)
+            {
+                count++;
+            }
+
+            if (c[1] == '@' || c[1] == '*')
+            {
+                string_buffer_clear(&arguments);
+                for (int i = 0; i < count; i++)
+                {
+                    if (i > 0)
+                    {
+                        string_buffer_append_char(&arguments, ' ');
+                    }
+                    string_buffer_append(&arguments, positional_parameters[i]);
+                }
+                value = arguments.data ? arguments.data : "";
+            }
+            else
+            {
+                value = c[1] - '1' < count ? positional_parameters[c[1] - '1'] : "";
+            }
+            c++;
+        }
+        else if (*c == '`' || (*c == '$' && c[1] == '('))
+        {
+            // $(cmd) and `cmd` are replaced by output of cmd
+            char *end = command_substitution_end(c);
+            if (end)
+            {
+                size_t skip = *c == '`' ? 1 : 2;
+                string_buffer_clear(&output);
+                capture_command(interpreter, c + skip, end - 1 - c - skip, &output);
+                value = output.data ? output.data : "";
+                c = end - 1;
+            }
+        }
+
+        if (name)
+        {
+            struct variable *variable = find_variable(interpreter, name, length);
+            value = variable && variable->value ? variable->value : "";
+        }
+
+        if (!value)
+        {
+            string_buffer_append_char(&result, *c);
+            has_word = true;
+        }
+        else if (split)
+        {
+            split_into_words(list, &result, &has_word, value);
+        }
+        else
+        {
+            string_buffer_append(&result, value);
+            has_word = true;
+        }
+    }
+
+    if (has_word || !split)
+    {
+        word_list_push(list, strdup(result.data));
+    }
+    string_buffer_free(&result);
+    string_buffer_free(&arguments);
+    string_buffer_free(&output);
+}
+
+// expands variables in word and adds what comes out to list, split into words and globbed
+void expand_argument(struct minibash *interpreter, char *word, struct word_list *list)
+{
+    // words which come out of variables are globbed as well
+    struct word_list words;
+    word_list_init(&words);
+    expand_word(interpreter, word, &words, true);
+    char **expanded = word_list_finish(&words);
+    for (int j = 0; expanded[j] != NULL; j++)
+    {
+        glob_word(expanded[j], list);
+    }
+    free_command(expanded);
+}
+
+// expands variables in all words of command and replaces it with the expanded one
+// value of an assignment, i.e. NAME=$VALUE is not split
+void expand_command(struct minibash *interpreter, char ***command)
+{
+    bool needs_expansion = false;
+    for (int i = 0; (*command)[i] != NULL && !needs_expansion; i++)
+    {
+        needs_expansion = strpbrk((*command)[i], "$*?[`") != NULL;
+    }
+
+    // nothing to expand, keep words as they are
+    if (!needs_expansion)
+    {
+        return;
+    }
+
+    struct word_list list;
+    word_list_init(&list);
+    int assignments_num = count_assignments(*command);
+
+    for (int i = 0; (*command)[i] != NULL; i++)
+    {
+        // values of assignments are neither split nor globbed
+        if (i < assignments_num)
+        {
+            expand_word(interpreter, (*command)[i], &list, false);
+            continue;
+        }
+
+        expand_argument(interpreter, (*command)[i], &list);
+    }
+
+    free_command(*command);
+    *command = word_list_finish(&list);
+}
+
+// expands variables in here documents of command whose word isn't quoted, of every command if command is -1
+void expand_here_documents(struct minibash *interpreter, int command)
+{
+    for (int i = 0; i < redirections_num; i++)
+    {
+        if ((command == -1 || redirections[i].command == command) && redirections[i].kind == FD_ACTION_DATA &&
+            redirections[i].flags && strpbrk(redirections[i].path, "$`"))
+        {
+            struct word_list list;
+            word_list_init(&list);
+            expand_word(interpreter, redirections[i].path, &list, false);
+            free(redirections[i].path);
+            redirections[i].path = list.words[0];
+            free(list.words);
+        }
+    }
+}
+
+// expands variables in all commands of input, and in their here documents
+// commands joined by ;, && or || are left to run_chained_command, a command can use what the one before it did
+void expand_commands(struct minibash *interpreter)
+{
+    if (is_special_char && selected_special_char >= 6 && selected_special_char != 7)
+    {
+        return;
+    }
+    expand_here_documents(interpreter, -1);
+
+    expand_command(interpreter, &command_1);
+    expand_command(interpreter, &command_2);
+    expand_command(interpreter, &command_3);
+    expand_command(interpreter, &command_4);
+
+    if (all_commands_pointer)
+    {
+        char **commands[] = {command_1, command_2, command_3, command_4};
+        for (int i = 0; i < 4 && all_commands_pointer[i] != NULL; i++)
+        {
+            all_commands_pointer[i] = commands[i];
+        }
+    }
+}
+
+// for export
+// export prints exported variables, export NAME=value sets and exports, export NAME only exports
+// returns 0 on success, -1 on error
+int export_command(struct minibash *interpreter, char *command[])
+{
+    if (command[1] == NULL)
+    {
+        init_variables(interpreter);
+        for (int i = 0; i < interpreter->variables_num; i++)
+        {
+            if (interpreter->variables[i].exported && interpreter->variables[i].value)
+            {
+                printf("export %s=%s\n", interpreter->variables[i].name, interpreter->variables[i].value);
+            }
+        }
+        return 0;
+    }
+
+    for (int i = 1; command[i] != NULL; i++)
+    {
+        int length = assignment_name_length(command[i]);
+
+        if (length > 0)
+        {
+            set_variable(interpreter, command[i], length, command[i] + length + 1, true);
+            continue;
+        }
+
+        length = strlen(command[i]);
+        for (int j = 0; j < length; j++)
+        {
+            if (!is_name_char(command[i][j], j == 0))
+            {
+                printf("export: %s: not a valid identifier\n", command[i]);
+                return -1;
+            }
+        }
+
+        struct variable *variable = find_variable(interpreter, command[i], length);
+        set_variable(interpreter, command[i], length, variable && variable->value ? variable->value : "", true);
+    }
+    return 0;
+}
+
+// for unset
+// returns 0 on success
+int unset_command(struct minibash *interpreter, char *command[])
+{
+    for (int i = 1; command[i] != NULL; i++)
+    {
+        set_variable(interpreter, command[i], strlen(command[i]), NULL, false);
+    }
+    return 0;
+}
+
+// converts what commands return to an exit code for $?
+// -1 means minibash failed to run the command, everything else is a wait status
+int exit_code(int status)
+{
+    if (status == -1)
+        return 1;
+    if (WIFEXITED(status))
+        return WEXITSTATUS(status);
+    if (WIFSIGNALED(status))
+        return 128 + WTERMSIG(status);
+    return 1;
+}
+
+// DIRECTORIES
+// returns home directory, $HOME or /home/$USER when HOME isn't set
+char *get_home(struct minibash *interpreter)
+{
+    if (interpreter->home_path == NULL)
+    {
+        char *home = get_variable(interpreter, "HOME");
+        struct string_buffer path;
+        string_buffer_init(&path);
+        if (home && home[0] != '\0')
+        {
+            string_buffer_append(&path, home);
+        }
+        else
+        {
+            char *user = getenv("USER");
+            string_buffer_append(&path, "/home/");
+            string_buffer_append(&path, user ? user : "");
+        }
+        interpreter->home_path = path.data;
+    }
+    return interpreter->home_path;
+}
+
+// returns physical path of directory fd, which is read from /proc, NULL on error
+char *get_fd_path(int fd)
+{
+    struct string_buffer path;
+    char link[32];
+    ssize_t length;
+
+    string_buffer_init(&path);
+    snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+    string_buffer_reserve(&path, 255);
+    while ((length = readlink(link, path.data, path.capacity - 1)) == (ssize_t)path.capacity - 1)
+    {
+        string_buffer_reserve(&path, path.capacity);
+    }
+    if (length == -1)
+    {
+        string_buffer_free(&path);
+        return NULL;
+    }
+    path.data[length] = '\0';
+    return path.data;
+}
+
+// returns logical path of current directory, NULL on error
+// it's worked out the first time it's needed, $PWD when that is the same directory, physical path otherwise
+char *get_cwd_path(struct minibash *interpreter)
+{
+    if (interpreter->cwd_path)
+    {
+        return interpreter->cwd_path;
+    }
+
+    struct stat pwd_info, info;
+    char *pwd = get_variable(interpreter, "PWD");
+    if (interpreter->cwd_fd != -1 && pwd && pwd[0] == '/' && stat(pwd, &pwd_info) == 0 &&
+        fstat(interpreter->cwd_fd, &info) == 0 && pwd_info.st_dev == info.st_dev && pwd_info.st_ino == info.st_ino)
+    {
+        interpreter->cwd_path = strdup(pwd);
+    }
+    else if (interpreter->cwd_fd != -1)
+    {
+        interpreter->cwd_path = get_fd_path(interpreter->cwd_fd);
+    }
+    else
+    {
+        struct string_buffer path;
+        string_buffer_init(&path);
+        if (get_current_directory(&path) == 1)
+        {
+            interpreter->cwd_path = path.data;
+        }
+        else
+        {
+            string_buffer_free(&path);
+        }
+    }
+    return interpreter->cwd_path;
+}
+
+// puts logical path of path, taken from directory base, in result
+// . and .. are removed without looking at the directories, so .. goes back out of a symlink like in bash
+void join_logical_path(struct string_buffer *result, const char *base, const char *path)
+{
+    string_buffer_clear(result);
+    string_buffer_append(result, ""); // so result->data is never NULL
+    if (path[0] != '/' && strcmp(base, "/") != 0)
+    {
+        string_buffer_append(result, base);
+    }
+
+    while (*path != '\0')
+    {
+        size_t length = strcspn(path, "/");
+        if (length == 2 && path[0] == '.' && path[1] == '.')
+        {
+            char *slash = strrchr(result->data, '/');
+            result->length = slash ? (size_t)(slash - result->data) : 0;
+            result->data[result->length] = '\0';
+        }
+        else if (length > 0 && !(length == 1 && path[0] == '.'))
+        {
+            string_buffer_append_char(result, '/');
+            string_buffer_append_length(result, path, length);
+        }
+        path += length + (path[length] == '/');
+    }
+
+    if (result->length == 0)
+    {
+        string_buffer_append_char(result, '/');
+    }
+}
+
+void close_directory(struct directory *directory)
+{
+    if (directory->fd != -1)
+    {
+        close(directory->fd);
+    }
+    free(directory->path);
+    directory->fd = -1;
+    directory->path = NULL;
+}
+
+// opens directory at path, which is taken logically from current directory, like cd of bash does
+// when logical path can't be opened, i.e. it went through a directory that's gone, path is taken physically
+// returns -1 on error
+int open_directory(struct minibash *interpreter, const char *path, struct directory *directory)
+{
+    char *base = path[0] == '/' ? "/" : get_cwd_path(interpreter);
+    struct string_buffer logical;
+    string_buffer_init(&logical);
+
+    directory->fd = -1;
+    if (base)
+    {
+        join_logical_path(&logical, base, path);
+        directory->fd = open(logical.data, O_PATH | O_DIRECTORY | O_CLOEXEC);
+    }
+    if (directory->fd == -1)
+    {
+        string_buffer_free(&logical);
+        int at = interpreter->cwd_fd == -1 ? AT_FDCWD : interpreter->cwd_fd;
+        directory->fd = openat(at, path, O_PATH | O_DIRECTORY | O_CLOEXEC);
+    }
+    directory->path = logical.data;
+    return directory->fd == -1 ? -1 : 0;
+}
+
+// keeps directory thread is in, before an interpreter changes it, so leaving interpreter can go back there
+void save_thread_cwd()
+{
+    if (thread_saved_cwd_fd == -1)
+    {
+        thread_saved_cwd_fd = open(".", O_PATH | O_DIRECTORY | O_CLOEXEC);
+        thread_saved_cwd_version = thread_cwd_version;
+    }
+}
+
+// changes thread back to directory it was in before an interpreter changed it
+void restore_thread_cwd()
+{
+    if (thread_saved_cwd_fd != -1)
+    {
+        if (fchdir(thread_saved_cwd_fd) == 0)
+        {
+            thread_cwd_version = thread_saved_cwd_version;
+        }
+        close(thread_saved_cwd_fd);
+        thread_saved_cwd_fd = -1;
+    }
+}
+
+// returns a copy of current directory, which has its own fd, fd is -1 on error
+struct directory copy_cwd(struct minibash *interpreter)
+{
+    char *path = get_cwd_path(interpreter);
+    struct directory copy = {-1, path ? strdup(path) : NULL};
+    if (interpreter->cwd_fd != -1)
+    {
+        copy.fd = fcntl(interpreter->cwd_fd, F_DUPFD_CLOEXEC, 0);
+    }
+    return copy;
+}
+
+// makes directory current directory, which then owns it, and current directory previous directory
+// thread changes to it right away, so a directory that can't be searched is refused here
+// returns -1 on error, nothing is changed then and caller still owns directory
+int change_directory(struct minibash *interpreter, struct directory directory)
+{
+    // directory of a thread sharing it with the whole process is only changed by the minibash program
+    if (!is_cwd_private && !is_program)
+    {
+        errno = EPERM;
+        return -1;
+    }
+    save_thread_cwd();
+    if (fchdir(directory.fd) == -1)
+    {
+        return -1;
+    }
+
+    // for cd -, previous directory is the new current one
+    if (interpreter->previous_directory.fd != directory.fd)
+    {
+        close_directory(&interpreter->previous_directory);
+    }
+    interpreter->previous_directory = (struct directory){interpreter->cwd_fd, interpreter->cwd_path};
+    interpreter->cwd_fd = directory.fd;
+    interpreter->cwd_path = directory.path;
+    interpreter->cwd_version = thread_cwd_version = __atomic_add_fetch(&cwd_versions, 1, __ATOMIC_RELAXED);
+
+    if (interpreter->cwd_path)
+    {
+        set_variable(interpreter, "PWD", 3, interpreter->cwd_path, false);
+    }
+    if (interpreter->previous_directory.path)
+    {
+        set_variable(interpreter, "OLDPWD", 6, interpreter->previous_directory.path, false);
+    }
+    return 0;
+}
+
+// opens path and makes it current directory, ~ at its start is home directory, name is the command for errors
+// returns -1 on error, which is printed
+int change_directory_to(struct minibash *interpreter, const char *path, const char *name)
+{
+    struct string_buffer expanded;
+    struct directory directory;
+    string_buffer_init(&expanded);
+
+    string_buffer_append(&expanded, "");
+    if (path[0] == '~' && (path[1] == '\0' || path[1] == '/'))
+    {
+        string_buffer_append(&expanded, get_home(interpreter));
+        string_buffer_append(&expanded, path + 1);
+    }
+    else
+    {
+        string_buffer_append(&expanded, path);
+    }
+
+    int ret_value = 0;
+    if (open_directory(interpreter, expanded.data, &directory) == -1)
+    {
+        printf("No Such Directory %s\n", path);
+        ret_value = -1;
+    }
+    else if (change_directory(interpreter, directory) == -1)
+    {
+        printf("%s: %s: %s\n", name, path, strerror(errno));
+        close_directory(&directory);
+        ret_value = -1;
+    }
+    string_buffer_free(&expanded);
+    return ret_value;
+}
+
+// prints path, with home directory at its start shown as ~
+void print_directory(struct minibash *interpreter, const char *path)
+{
+    char *home = get_home(interpreter);
+    size_t length = strlen(home);
+
+    if (!path)
+    {
+        printf("?");
+    }
+    else if (length > 1 && strncmp(path, home, length) == 0 && (path[length] == '/' || path[length] == '\0'))
+    {
+        printf("~%s", path + length);
+    }
+    else
+    {
+        printf("%s", path);
+    }
+}
+
+// prints current directory and directories of pushd, top first
+void print_directory_stack(struct minibash *interpreter)
+{
+    print_directory(interpreter, get_cwd_path(interpreter));
+    for (int i = interpreter->directory_stack_num - 1; i >= 0; i--)
+    {
+        printf(" ");
+        print_directory(interpreter, interpreter->directory_stack[i].path);
+    }
+    printf("\n");
+}
+
+// GLOBS
+// for qsort_r, names is names of the listing being sorted
+int compare_dir_entries(const void *a, const void *b, void *names)
+{
+    return strcmp((char *)names + ((const struct dir_entry *)a)->name_offset,
+                  (char *)names + ((const struct dir_entry *)b)->name_offset);
+}
+
+// reads entries of directory fd with getdents64 into listing, . and .. are left out
+// returns -1 on error
+int read_dir_listing(int fd, struct dir_listing *listing)
+{
+    long buffer[DIR_READ_SIZE / sizeof(long)]; // long for alignment of dirent64
+    struct string_buffer names;
+    int capacity = 64;
+    ssize_t read_num;
+
+    string_buffer_init(&names);
+    listing->entries = malloc(sizeof(struct dir_entry) * capacity);
+    listing->entries_num = 0;
+
+    while ((read_num = getdents64(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t offset = 0; offset < read_num;)
+        {
+            struct dirent64 *entry = (struct dirent64 *)((char *)buffer + offset);
+            offset += entry->d_reclen;
+
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            {
+                continue;
+            }
+            if (listing->entries_num == capacity)
+            {
+                capacity *= 2;
+                listing->entries = realloc(listing->entries, sizeof(struct dir_entry) * capacity);
+            }
+            listing->entries[listing->entries_num].name_offset = names.length;
+            listing->entries[listing->entries_num].type = entry->d_type;
+            listing->entries_num++;
+            string_buffer_append_length(&names, entry->d_name, strlen(entry->d_name) + 1);
+        }
+    }
+
+    if (read_num == -1)
+    {
+        free(listing->entries);
+        string_buffer_free(&names);
+        return -1;
+    }
+
+    listing->names = names.data;
+    qsort_r(listing->entries, listing->entries_num, sizeof(struct dir_entry), compare_dir_entries, listing->names);
+    return 0;
+}
+
+// frees listings of dir_cache of this thread, destructor of dir_cache_key
+void free_dir_cache(void *cache)
+{
+    struct dir_listing *listings = cache;
+    for (int i = 0; i < dir_cache_num; i++)
+    {
+        free(listings[i].names);
+        free(listings[i].entries);
+    }
+    dir_cache_num = 0;
+}
+
+void create_dir_cache_key()
+{
+    pthread_key_create(&dir_cache_key, free_dir_cache);
+}
+
+// returns listing of directory at path, read again only if directory has changed since it was cached
+// returns NULL if path isn't a directory that can be read
+struct dir_listing *get_dir_listing(const char *path)
+{
+    struct stat info;
+    struct dir_listing *listing = NULL;
+
+    if (stat(path, &info) == -1 || !S_ISDIR(info.st_mode))
+    {
+        return NULL;
+    }
+
+    for (int i = 0; i < dir_cache_num; i++)
+    {
+        if (dir_cache[i].device == info.st_dev && dir_cache[i].inode == info.st_ino)
+        {
+            listing = &dir_cache[i];
+            break;
+        }
+    }
+
+    if (listing && listing->mtime.tv_sec == info.st_mtim.tv_sec && listing->mtime.tv_nsec == info.st_mtim.tv_nsec)
+    {
+        listing->last_used = ++dir_cache_clock;
+        return listing;
+    }
+
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return NULL;
+    }
+
+    // mtime is taken before reading, so changes made while reading make the listing stale
+    struct dir_listing fresh;
+    if (fstat(fd, &info) == -1 || read_dir_listing(fd, &fresh) == -1)
+    {
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    fresh.device = info.st_dev;
+    fresh.inode = info.st_ino;
+    fresh.mtime = info.st_mtim;
+    fresh.last_used = ++dir_cache_clock;
+
+    // replace stale listing of this directory, a free slot or the least recently used one
+    if (!listing && dir_cache_num < DIR_CACHE_SIZE)
+    {
+        // first listing of thread, so that it's freed when thread exits
+        if (dir_cache_num == 0)
+        {
+            pthread_once(&dir_cache_once, create_dir_cache_key);
+            pthread_setspecific(dir_cache_key, dir_cache);
+        }
+        listing = &dir_cache[dir_cache_num++];
+    }
+    else
+    {
+        if (!listing)
+        {
+            listing = &dir_cache[0];
+            for (int i = 1; i < dir_cache_num; i++)
+            {
+                if (dir_cache[i].last_used < listing->last_used)
+                {
+                    listing = &dir_cache[i];
+                }
+            }
+        }
+        free(listing->names);
+        free(listing->entries);
+    }
+    *listing = fresh;
+    return listing;
+}
+
+// returns true if length characters of pattern have *, ? or [ in them
+bool has_glob_chars(const char *pattern, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        if (pattern[i] == '*' || pattern[i] == '?' || pattern[i] == '[')
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// adds paths matching pattern to list, path is what has been matched so far
+// path is restored before returning, returns number of paths added
+int glob_path(struct string_buffer *path, const char *pattern, struct word_list *list)
+{
+    size_t path_length = path->length;
+    size_t length = 0;
+    const char *slash = NULL;
+    int matches_num = 0;
+
+    // components without glob characters are taken as they are
+    while (*pattern != '\0')
+    {
+        slash = strchr(pattern, '/');
+        length = slash ? (size_t)(slash - pattern) : strlen(pattern);
+        if (has_glob_chars(pattern, length))
+        {
+            break;
+        }
+        length += slash ? 1 : 0;
+        string_buffer_append_length(path, pattern, length);
+        pattern += length;
+    }
+    size_t prefix_length = path->length;
+
+    if (*pattern == '\0')
+    {
+        // whole pattern is matched, path still has to exist
+        struct stat info;
+        if (lstat(path->data, &info) == 0)
+        {
+            word_list_push(list, strdup(path->data));
+            matches_num = 1;
+        }
+    }
+    else
+    {
+        struct dir_listing *listing = get_dir_listing(path->length > 0 ? path->data : ".");
+        char *component = strndup(pattern, length);
+        const char *rest = slash ? slash + 1 : NULL;
+        bool match_all = strcmp(component, "*") == 0;
+        struct word_list directories;
+        word_list_init(&directories);
+
+        for (int i = 0; listing && i < listing->entries_num; i++)
+        {
+            struct dir_entry *entry = &listing->entries[i];
+            char *name = listing->names + entry->name_offset;
+
+            // hidden files only match a pattern which starts with a dot
+            if (match_all ? name[0] == '.' : fnmatch(component, name, FNM_PERIOD) != 0)
+            {
+                continue;
+            }
+
+            if (!rest)
+            {
+                path->length = prefix_length;
+                string_buffer_append(path, name);
+                word_list_push(list, strdup(path->data));
+                matches_num++;
+            }
+            else if (entry->type == DT_DIR || entry->type == DT_LNK || entry->type == DT_UNKNOWN)
+            {
+                // copied, as going deeper may push this listing out of the cache
+                word_list_push(&directories, strdup(name));
+            }
+        }
+
+        for (int i = 0; i < directories.count; i++)
+        {
+            path->length = prefix_length;
+            string_buffer_append(path, directories.words[i]);
+            string_buffer_append_char(path, '/');
+            matches_num += glob_path(path, rest, list);
+        }
+        free_command(word_list_finish(&directories));
+        free(component);
+    }
+
+    path->length = path_length;
+    path->data[path_length] = '\0';
+    return matches_num;
+}
+
+// adds word to list, or paths it matches when it has *, ? or [ in it
+// like bash, a pattern which matches nothing is kept as it is
+void glob_word(char *word, struct word_list *list)
+{
+    if (!has_glob_chars(word, strlen(word)))
+    {
+        word_list_push(list, strdup(word));
+        return;
+    }
+
+    struct string_buffer path;
+    string_buffer_init(&path);
+    string_buffer_append(&path, ""); // so path.data is never NULL
+
+    if (glob_path(&path, word, list) == 0)
+    {
+        word_list_push(list, strdup(word));
+    }
+    string_buffer_free(&path);
+}
+
+// NAMES
+// FNV-1a hash of length characters of name
+unsigned int hash_name(const char *name, size_t length)
+{
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// doubles number of buckets once table is 3/4 full
+void grow_name_table(struct minibash *interpreter)
+{
+    int buckets = interpreter->name_table_buckets ? interpreter->name_table_buckets * 2 : NAME_TABLE_SIZE;
+    struct name_entry **table = calloc(buckets, sizeof(struct name_entry *));
+
+    for (int i = 0; i < interpreter->name_table_buckets; i++)
+    {
+        struct name_entry *entry = interpreter->name_table[i];
+        while (entry)
+        {
+            struct name_entry *next = entry->next;
+            entry->next = table[entry->hash & (buckets - 1)];
+            table[entry->hash & (buckets - 1)] = entry;
+            entry = next;
+        }
+    }
+    free(interpreter->name_table);
+    interpreter->name_table = table;
+    interpreter->name_table_buckets = buckets;
+}
+
+// returns entry of name of given length, creates it when create is true
+// returns NULL if there is no such entry and create is false
+struct name_entry *find_name(struct minibash *interpreter, const char *name, size_t length, bool create)
+{
+    if (interpreter->name_table == NULL)
+    {
+        // builtins are the first names of table
+        grow_name_table(interpreter);
+        for (int i = 0; i < SPECIAL_COMMANDS; i++)
+        {
+            find_name(interpreter, custom_commands[i], strlen(custom_commands[i]), true)->builtin = i;
+        }
+    }
+
+    unsigned int hash = hash_name(name, length);
+    struct name_entry **bucket = &interpreter->name_table[hash & (interpreter->name_table_buckets - 1)];
+    for (struct name_entry *entry = *bucket; entry; entry = entry->next)
+    {
+        if (entry->hash == hash && strncmp(entry->name, name, length) == 0 && entry->name[length] == '\0')
+        {
+            return entry;
+        }
+    }
+
+    if (!create)
+    {
+        return NULL;
+    }
+
+    if (interpreter->name_table_count + 1 > interpreter->name_table_buckets / 4 * 3)
+    {
+        grow_name_table(interpreter);
+    }
+
+    struct name_entry *entry = calloc(1, sizeof(struct name_entry));
+    entry->name = strndup(name, length);
+    entry->hash = hash;
+    entry->builtin = -1;
+    entry->next = interpreter->name_table[hash & (interpreter->name_table_buckets - 1)];
+    interpreter->name_table[hash & (interpreter->name_table_buckets - 1)] = entry;
+    interpreter->name_table_count++;
+    return entry;
+}
+
+// forgets where commands were found in PATH
+void clear_path_cache(struct minibash *interpreter)
+{
+    for (int i = 0; i < interpreter->name_table_buckets; i++)
+    {
+        for (struct name_entry *entry = interpreter->name_table[i]; entry; entry = entry->next)
+        {
+            free(entry->path);
+            entry->path = NULL;
+        }
+    }
+}
+
+// returns copy of where name was found in directories by any thread, NULL if it wasn't looked up yet
+char *find_shared_path(const char *name, unsigned int hash, const char *directories)
+{
+    char *path = NULL;
+
+    pthread_mutex_lock(&shared_paths_lock);
+    for (struct shared_path *entry = shared_paths[hash % SHARED_PATHS_SIZE]; entry; entry = entry->next)
+    {
+        if (strcmp(entry->name, name) == 0 && strcmp(entry->directories, directories) == 0)
+        {
+            path = strdup(entry->path);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&shared_paths_lock);
+    return path;
+}
+
+// frees every PATH lookup, shared_paths_lock has to be held
+void free_shared_paths()
+{
+    for (int i = 0; i < SHARED_PATHS_SIZE; i++)
+    {
+        struct shared_path *entry = shared_paths[i];
+        while (entry)
+        {
+            struct shared_path *next = entry->next;
+            free(entry->name);
+            free(entry->directories);
+            free(entry->path);
+            free(entry);
+            entry = next;
+        }
+        shared_paths[i] = NULL;
+    }
+    shared_paths_num = 0;
+}
+
+// lets every thread know name was found at path in directories
+// lookups of many PATHs would pile up otherwise, so they're all forgotten once there are SHARED_PATHS_MAX
+void add_shared_path(const char *name, unsigned int hash, const char *directories, const char *path)
+{
+    struct shared_path *entry = malloc(sizeof(struct shared_path));
+    entry->name = strdup(name);
+    entry->directories = strdup(directories);
+    entry->path = strdup(path);
+
+    pthread_mutex_lock(&shared_paths_lock);
+    if (shared_paths_num >= SHARED_PATHS_MAX)
+    {
+        free_shared_paths();
+    }
+    entry->next = shared_paths[hash % SHARED_PATHS_SIZE];
+    shared_paths[hash % SHARED_PATHS_SIZE] = entry;
+    shared_paths_num++;
+    pthread_mutex_unlock(&shared_paths_lock);
+}
+
+// forgets where commands were found in PATH by every thread
+void clear_shared_paths()
+{
+    pthread_mutex_lock(&shared_paths_lock);
+    free_shared_paths();
+    pthread_mutex_unlock(&shared_paths_lock);
+}
+
+// returns path of executable name, it's searched in PATH only the first time and cached after that
+// a name another thread has already found in the same PATH isn't searched for again
+// returns name itself if it has a / or isn't found, exec_command reports it then
+char *find_executable(struct minibash *interpreter, char *name)
+{
+    if (strchr(name, '/') || name[0] == '\0')
+    {
+        return name;
+    }
+
+    struct name_entry *entry = find_name(interpreter, name, strlen(name), true);
+    if (entry->path)
+    {
+        return entry->path;
+    }
+
+    char *directories = get_variable(interpreter, "PATH");
+    if (directories && (entry->path = find_shared_path(name, entry->hash, directories)))
+    {
+        return entry->path;
+    }
+    struct string_buffer path;
+    string_buffer_init(&path);
+
+    for (char *directory = directories; directory && entry->path == NULL;)
+    {
+        size_t length = strcspn(directory, ":");
+        struct stat info;
+
+        // empty directory in PATH is current directory
+        string_buffer_clear(&path);
+        string_buffer_append_length(&path, length ? directory : ".", length ? length : 1);
+        string_buffer_append_char(&path, '/');
+        string_buffer_append(&path, name);
+        if (stat(path.data, &info) == 0 && S_ISREG(info.st_mode) && access(path.data, X_OK) == 0)
+        {
+            entry->path = strdup(path.data);
+        }
+
+        directory = directory[length] == ':' ? directory + length + 1 : NULL;
+    }
+    string_buffer_free(&path);
+
+    // what a relative directory of PATH finds depends on current directory, so it isn't shared
+    if (entry->path && entry->path[0] == '/')
+    {
+        add_shared_path(name, entry->hash, directories, entry->path);
+    }
+    return entry->path ? entry->path : name;
+}
+
+// execs command from path found by find_executable, returns only on error
+int exec_command(char *path, char *command[], char **environment)
+{
+    if (path != command[0])
+    {
+        execve(path, command, environment);
+    }
+    // not found in PATH, or gone since it was cached, so let execvpe search for it
+    return execvpe(command[0], command, environment);
+}
+
+// drops a reference to function, frees it when it was the last one
+void release_function(struct function *function)
+{
+    if (function && --function->references == 0)
+    {
+        free_statements(&function->body);
+        free(function);
+    }
+}
+
+// makes name call function, replacing function it called before
+void define_function(struct minibash *interpreter, char *name, struct function *function)
+{
+    struct name_entry *entry = find_name(interpreter, name, strlen(name), true);
+    function->references++;
+    release_function(entry->function);
+    entry->function = function;
+}
+
+// moves everything about input being run into state and leaves globals empty
+void save_input_state(struct input_state *state)
+{
+    state->selected_special_char = selected_special_char;
+    state->special_char_num = special_char_num;
+    state->is_special_char = is_special_char;
+    state->is_conditional = is_conditional;
+    state->is_multiple_conditional = is_multiple_conditional;
+    memcpy(state->multiple_conditionals_sequence, multiple_conditionals_sequence, sizeof(multiple_conditionals_sequence));
+    state->selected_custom_command = selected_custom_command;
+
+    char ***commands[] = {&command_1, &command_2, &command_3, &command_4};
+    for (int i = 0; i < 4; i++)
+    {
+        state->commands[i] = *commands[i];
+        *commands[i] = empty_command;
+    }
+    state->all_commands = all_commands;
+    all_commands = empty_command;
+    state->all_commands_pointer = all_commands_pointer;
+    all_commands_pointer = NULL;
+
+    memcpy(state->redirections, redirections, sizeof(struct fd_action) * redirections_num);
+    state->redirections_num = redirections_num;
+    state->redirection_position = redirection_position;
+    redirections_num = 0;
+    redirection_position = 0;
+    memcpy(state->substitutions, substitutions, sizeof(struct process_substitution) * substitutions_num);
+    state->substitutions_num = substitutions_num;
+    substitutions_num = 0;
+}
+
+// frees whatever is in globals and moves state back into them
+void restore_input_state(struct input_state *state)
+{
+    reset();
+
+    selected_special_char = state->selected_special_char;
+    special_char_num = state->special_char_num;
+    is_special_char = state->is_special_char;
+    is_conditional = state->is_conditional;
+    is_multiple_conditional = state->is_multiple_conditional;
+    memcpy(multiple_conditionals_sequence, state->multiple_conditionals_sequence, sizeof(multiple_conditionals_sequence));
+    selected_custom_command = state->selected_custom_command;
+
+    char ***commands[] = {&command_1, &command_2, &command_3, &command_4};
+    for (int i = 0; i < 4; i++)
+    {
+        *commands[i] = state->commands[i];
+    }
+    all_commands = state->all_commands;
+    all_commands_pointer = state->all_commands_pointer;
+
+    memcpy(redirections, state->redirections, sizeof(struct fd_action) * state->redirections_num);
+    redirections_num = state->redirections_num;
+    redirection_position = state->redirection_position;
+    memcpy(substitutions, state->substitutions, sizeof(struct process_substitution) * state->substitutions_num);
+    substitutions_num = state->substitutions_num;
+}
+
+// runs function with arguments of command, command[0] is name of function
+// returns exit code of function as a wait status, like a command that exited with it
+int run_function(struct minibash *interpreter, struct function *function, char *command[])
+{
+    if (function_depth >= FUNCTION_DEPTH_MAX)
+    {
+        printf("minibash: %s: maximum function nesting level exceeded\n", command[0]);
+        return -1;
+    }
+
+    struct input_state state;
+    char **saved_parameters = positional_parameters;
+
+    // input which called function stays as it is, commands of function are inputs of their own
+    save_input_state(&state);
+    positional_parameters = command + 1;
+    function->references++;
+    function_depth++;
+
+    int code = run_statements(interpreter, &function->body);
+
+    function_depth--;
+    release_function(function);
+    positional_parameters = saved_parameters;
+    restore_input_state(&state);
+    return code << 8;
+}
+
+// replaces first word of every command in input with its alias
+// words put in by an alias aren't replaced again, so alias ls=ls -F works
+void expand_aliases(struct minibash *interpreter, struct string_buffer *input)
+{
+    if (interpreter->aliases_num == 0)
+    {
+        return;
+    }
+
+    struct string_buffer result;
+    string_buffer_init(&result);
+    bool is_command_start = true;
+
+    for (char *c = input->data; *c != '\0';)
+    {
+        // bodies of here documents are kept as they are
+        if (*c == HERE_DOCUMENT_MARKER)
+        {
+            string_buffer_append(&result, c);
+            break;
+        }
+
+        if (is_command_start)
+        {
+            while (*c == ' ' || *c == '\t')
+            {
+                string_buffer_append_char(&result, *c++);
+            }
+
+            size_t length = strcspn(c, " \t;|&+<>");
+            struct name_entry *entry = length ? find_name(interpreter, c, length, false) : NULL;
+            if (entry && entry->alias)
+            {
+                string_buffer_append(&result, entry->alias);
+            }
+            else
+            {
+                string_buffer_append_length(&result, c, length);
+            }
+            c += length;
+            is_command_start = false;
+            continue;
+        }
+
+        // a new command starts after ;, |, ||, && and +
+        if (*c == ';' || *c == '|' || *c == '+' || (*c == '&' && c[1] == '&'))
+        {
+            if ((*c == '|' || *c == '&') && c[1] == *c)
+            {
+                string_buffer_append_char(&result, *c++);
+            }
+            is_command_start = true;
+        }
+        string_buffer_append_char(&result, *c++);
+    }
+
+    string_buffer_clear(input);
+    string_buffer_append_length(input, result.data ? result.data : "", result.length);
+    string_buffer_free(&result);
+}
+
+// for alias
+// alias lists aliases, alias NAME shows one, alias NAME=value words makes NAME stand for value words
+// returns 0 on success, -1 on error
+int alias_command(struct minibash *interpreter, char *command[])
+{
+    if (command[1] == NULL)
+    {
+        find_name(interpreter, "", 0, false); // makes sure table exists
+        for (int i = 0; i < interpreter->name_table_buckets; i++)
+        {
+            for (struct name_entry *entry = interpreter->name_table[i]; entry; entry = entry->next)
+            {
+                if (entry->alias)
+                {
+                    printf("alias %s=%s\n", entry->name, entry->alias);
+                }
+            }
+        }
+        return 0;
+    }
+
+    char *equals = strchr(command[1], '=');
+    if (equals == NULL)
+    {
+        struct name_entry *entry = find_name(interpreter, command[1], strlen(command[1]), false);
+        if (!entry || !entry->alias)
+        {
+            printf("alias: %s: not found\n", command[1]);
+            return -1;
+        }
+        printf("alias %s=%s\n", entry->name, entry->alias);
+        return 0;
+    }
+
+    if (equals == command[1] || strcspn(command[1], " \t;|&+<>/$") < (size_t)(equals - command[1]))
+    {
+        printf("alias: %s: invalid alias name\n", command[1]);
+        return -1;
+    }
+
+    // there's no quoting, so rest of the words are part of the value
+    struct string_buffer value;
+    string_buffer_init(&value);
+    string_buffer_append(&value, equals + 1);
+    for (int i = 2; command[i] != NULL; i++)
+    {
+        string_buffer_append_char(&value, ' ');
+        string_buffer_append(&value, command[i]);
+    }
+
+    struct name_entry *entry = find_name(interpreter, command[1], equals - command[1], true);
+    if (!entry->alias)
+    {
+        interpreter->aliases_num++;
+    }
+    free(entry->alias);
+    entry->alias = strdup(value.data ? value.data : "");
+    string_buffer_free(&value);
+    return 0;
+}
+
+// for unalias
+// returns -1 if a name isn't an alias
+int unalias_command(struct minibash *interpreter, char *command[])
+{
+    int ret_value = 0;
+    for (int i = 1; command[i] != NULL; i++)
+    {
+        struct name_entry *entry = find_name(interpreter, command[i], strlen(command[i]), false);
+        if (!entry || !entry->alias)
+        {
+            printf("unalias: %s: not found\n", command[i]);
+            ret_value = -1;
+            continue;
+        }
+        free(entry->alias);
+        entry->alias = NULL;
+        interpreter->aliases_num--;
+    }
+    return ret_value;
+}
+
+// for hash
+// hash lists where commands were found, hash -r forgets them, hash NAME looks NAME up now
+// returns -1 if a name isn't found
+int hash_command(struct minibash *interpreter, char *command[])
+{
+    if (command[1] == NULL)
+    {
+        find_name(interpreter, "", 0, false); // makes sure table exists
+        for (int i = 0; i < interpreter->name_table_buckets; i++)
+        {
+            for (struct name_entry *entry = interpreter->name_table[i]; entry; entry = entry->next)
+            {
+                if (entry->path)
+                {
+                    printf("%s\t%s\n", entry->name, entry->path);
+                }
+            }
+        }
+        return 0;
+    }
+
+    if (strcmp(command[1], "-r") == 0)
+    {
+        clear_path_cache(interpreter);
+        clear_shared_paths();
+        return 0;
+    }
+
+    int ret_value = 0;
+    for (int i = 1; command[i] != NULL; i++)
+    {
+        if (find_executable(interpreter, command[i]) == command[i])
+        {
+            printf("hash: %s: not found\n", command[i]);
+            ret_value = -1;
+        }
+    }
+    return ret_value;
+}
+
+// HISTORY
+// opens history file, only done when history is first needed
+// returns -1 if there's no history file
+int open_history(struct minibash *interpreter)
+{
+    if (history_fd != -1)
+    {
+        return 1;
+    }
+
+    struct string_buffer path;
+    string_buffer_init(&path);
+    char *file = get_variable(interpreter, "HISTFILE");
+    if (file)
+    {
+        string_buffer_append(&path, file);
+    }
+    else
+    {
+        char *home = get_variable(interpreter, "HOME");
+        if (!home)
+        {
+            return -1;
+        }
+        string_buffer_append(&path, home);
+        string_buffer_append_char(&path, '/');
+        string_buffer_append(&path, HISTORY_FILE);
+    }
+
+    // O_APPEND, so lines of different instances are never written over each other
+    history_fd = open(path.data, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    string_buffer_free(&path);
+    return history_fd == -1 ? -1 : 1;
+}
+
+// returns key of trigram at bytes when length is 3, of length starting bytes of a line when it's 1 or 2
+// starting bytes have their count above them and trigrams the top bit, so keys never collide and none is 0
+// starting 3 bytes are a trigram too, a prefix search only looks at lines having it and checks their start
+unsigned int history_key(const char *bytes, size_t length)
+{
+    unsigned int key = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        key = key << 8 | (unsigned char)bytes[i];
+    }
+    return length < 3 ? key | (unsigned int)length << 24 : key | 1u << 31;
+}
+
+// returns postings of key in history index, NULL if it has none and is_added is false
+// history_lock is held by caller
+struct history_postings *find_history_postings(unsigned int key, bool is_added)
+{
+    if (is_added && (history_index_used + 1) * 2 > history_index_capacity)
+    {
+        // grow, postings keep their lines and only move to their new bucket
+        struct history_postings *old = history_index;
+        int old_capacity = history_index_capacity;
+        history_index_capacity = old_capacity ? old_capacity * 2 : HISTORY_INDEX_SIZE;
+        history_index = calloc(history_index_capacity, sizeof(struct history_postings));
+        for (int i = 0; i < old_capacity; i++)
+        {
+            if (old[i].key)
+            {
+                unsigned int bucket = old[i].key * 2654435761u & (history_index_capacity - 1);
+                while (history_index[bucket].key)
+                {
+                    bucket = (bucket + 1) & (history_index_capacity - 1);
+                }
+                history_index[bucket] = old[i];
+            }
+        }
+        free(old);
+    }
+    if (history_index_capacity == 0)
+    {
+        return NULL;
+    }
+
+    unsigned int bucket = key * 2654435761u & (history_index_capacity - 1);
+    while (history_index[bucket].key && history_index[bucket].key != key)
+    {
+        bucket = (bucket + 1) & (history_index_capacity - 1);
+    }
+    if (history_index[bucket].key == 0)
+    {
+        if (!is_added)
+        {
+            return NULL;
+        }
+        history_index[bucket].key = key;
+        history_index_used++;
+    }
+    return &history_index[bucket];
+}
+
+// adds line of history at index to postings of key, once even if line has key more than once
+void add_history_posting(unsigned int key, int index)
+{
+    struct history_postings *postings = find_history_postings(key, true);
+    if (postings->lines_num > 0 && postings->lines[postings->lines_num - 1] == index)
+    {
+        return;
+    }
+    if (postings->lines_num == postings->lines_capacity)
+    {
+        postings->lines_capacity = postings->lines_capacity ? postings->lines_capacity * 2 : 4;
+        postings->lines = realloc(postings->lines, sizeof(int) * postings->lines_capacity);
+    }
+    postings->lines[postings->lines_num++] = index;
+}
+
+// adds line at index to history index, under every trigram of it and under its first 1 and 2 bytes
+void index_history_line(int index, const char *line, size_t length)
+{
+    for (size_t i = 1; i < 3 && i <= length; i++)
+    {
+        add_history_posting(history_key(line, i), index);
+    }
+    for (size_t i = 0; i + 3 <= length; i++)
+    {
+        add_history_posting(history_key(line + i, 3), index);
+    }
+}
+
+// frees history index, when history file is indexed again from its start
+void free_history_index()
+{
+    for (int i = 0; i < history_index_capacity; i++)
+    {
+        free(history_index[i].lines);
+    }
+    free(history_index);
+    history_index = NULL;
+    history_index_capacity = 0;
+    history_index_used = 0;
+}
+
+// maps what has been appended to history since last time and indexes new lines
+// history file that got smaller, i.e. was truncated, is mapped and indexed again from its start,
+// since pages of the old mapping past its end can't be read anymore
+// history_lock is held by caller
+// returns number of lines in history
+int refresh_history(struct minibash *interpreter)
+{
+    struct stat info;
+
+    if (open_history(interpreter) == -1 || fstat(history_fd, &info) == -1)
+    {
+        return history_lines_num;
+    }
+
+    size_t size = info.st_size;
+    if (size < history_map_size)
+    {
+        munmap(history_map, history_map_size);
+        history_map = NULL;
+        history_map_size = 0;
+        history_indexed = 0;
+        history_lines_num = 0;
+        free_history_index();
+    }
+    if (size <= history_map_size)
+    {
+        return history_lines_num;
+    }
+
+    char *map = history_map
+                    ? mremap(history_map, history_map_size, size, MREMAP_MAYMOVE)
+                    : mmap(NULL, size, PROT_READ, MAP_SHARED, history_fd, 0);
+    if (map == MAP_FAILED)
+    {
+        return history_lines_num;
+    }
+    history_map = map;
+    history_map_size = size;
+
+    // index complete lines, a line still being written by another instance is left for later
+    for (char *end = memchr(map + history_indexed, '\n', size - history_indexed); end;
+         end = memchr(map + history_indexed, '\n', size - history_indexed))
+    {
+        if (history_lines_num == history_lines_capacity)
+        {
+            history_lines_capacity = history_lines_capacity ? history_lines_capacity * 2 : 1024;
+            history_lines = realloc(history_lines, sizeof(size_t) * history_lines_capacity);
+        }
+        index_history_line(history_lines_num, map + history_indexed, end - (map + history_indexed));
+        history_lines[history_lines_num++] = history_indexed;
+        history_indexed = end - map + 1;
+    }
+    return history_lines_num;
+}
+
+// returns line of history at index, length is set to its length
+// history_lock is held by caller
+char *history_line(int index, size_t *length)
+{
+    size_t end = index + 1 < history_lines_num ? history_lines[index + 1] : history_indexed;
+    *length = end - history_lines[index] - 1;
+    return history_map + history_lines[index];
+}
+
+// returns postings a search for query only has to look at, the rarest trigram of query, or its first bytes
+// when is_prefix, NULL if every line has to be looked at, i.e. for a query of less than 3 bytes
+// none is set when no line can have query
+// history_lock is held by caller
+struct history_postings *choose_history_postings(const char *query, size_t length, bool is_prefix, bool *none)
+{
+    struct history_postings *chosen = NULL;
+    *none = false;
+    if (is_prefix && length > 0)
+    {
+        chosen = find_history_postings(history_key(query, length < 3 ? length : 3), false);
+        *none = chosen == NULL;
+        return chosen;
+    }
+    for (size_t i = 0; !is_prefix && i + 3 <= length; i++)
+    {
+        struct history_postings *postings = find_history_postings(history_key(query + i, 3), false);
+        if (!postings)
+        {
+            *none = true;
+            return NULL;
+        }
+        if (!chosen || postings->lines_num < chosen->lines_num)
+        {
+            chosen = postings;
+        }
+    }
+    return chosen;
+}
+
+// returns position in postings of first line from start in direction step, lines_num or -1 if there's none
+int find_history_posting(struct history_postings *postings, int start, int step)
+{
+    // first position whose line is after start, or at start when going forward
+    int low = 0, high = postings->lines_num;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (postings->lines[middle] < start + (step < 0))
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return step < 0 ? low - 1 : low;
+}
+
+// returns index of first line from start, going in direction step, which has query at its start
+// or anywhere in it when is_prefix is false, returns -1 if no line has it
+// lines same as skip are passed over, so that moving through history doesn't stop at duplicates
+// only lines of the rarest trigram of query are looked at, or of its first bytes for a prefix, every line is
+// looked at only for a query of 1 or 2 bytes that isn't a prefix, which most lines have anyway
+int find_history(const char *query, size_t length, int start, int step, bool is_prefix, const char *skip)
+{
+    int found = -1;
+    bool none;
+    pthread_mutex_lock(&history_lock);
+    struct history_postings *postings = choose_history_postings(query, length, is_prefix, &none);
+    int position = postings ? find_history_posting(postings, start, step) : -1;
+    int i = !postings ? start : position >= 0 && position < postings->lines_num ? postings->lines[position] : -1;
+
+    while (!none && i >= 0 && i < history_lines_num)
+    {
+        size_t line_length;
+        char *line = history_line(i, &line_length);
+        bool is_match = is_prefix ? line_length >= length && memcmp(line, query, length) == 0
+                                  : memmem(line, line_length, query, length) != NULL;
+
+        if (is_match && !(skip && strlen(skip) == line_length && memcmp(line, skip, line_length) == 0))
+        {
+            found = i;
+            break;
+        }
+
+        if (postings)
+        {
+            position += step;
+            i = position >= 0 && position < postings->lines_num ? postings->lines[position] : -1;
+        }
+        else
+        {
+            i += step;
+        }
+    }
+    pthread_mutex_unlock(&history_lock);
+    return found;
+}
+
+// appends a line to history file
+void add_history(struct minibash *interpreter, char *line)
+{
+    pthread_mutex_lock(&history_lock);
+    if (line[0] != '\0' && open_history(interpreter) != -1)
+    {
+        // one write, so a line is never split by lines of other instances
+        struct string_buffer entry;
+        string_buffer_init(&entry);
+        string_buffer_append(&entry, line);
+        string_buffer_append_char(&entry, '\n');
+        write_all(history_fd, entry.data, entry.length);
+        string_buffer_free(&entry);
+    }
+    pthread_mutex_unlock(&history_lock);
+}
+
+// for history
+// history shows all lines, history N shows last N lines
+// returns 0 on success, -1 on error
+int history_command(struct minibash *interpreter, char *command[])
+{
+    long last = -1;
+    if (command[1] != NULL)
+    {
+        char *end;
+        last = strtol(command[1], &end, 10);
+        if (*end != '\0' || last < 0)
+        {
+            printf("history: %s: numeric argument required\n", command[1]);
+            return -1;
+        }
+    }
+
+    pthread_mutex_lock(&history_lock);
+    int count = refresh_history(interpreter);
+    int start = last != -1 && last < count ? count - last : 0;
+    for (int i = start; i < count; i++)
+    {
+        size_t length;
+        char *line = history_line(i, &length);
+        printf("%5d  %.*s\n", i + 1, (int)length, line);
+    }
+    pthread_mutex_unlock(&history_lock);
+    return 0;
+}
+
+// COMPLETION
+// for qsort, sorts array of strings
+int compare_words(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// frees directories of PATH index
+void free_path_index()
+{
+    for (int i = 0; i < path_index_num; i++)
+    {
+        free(path_index[i].path);
+        if (path_index[i].is_read)
+        {
+            free(path_index[i].listing.names);
+            free(path_index[i].listing.entries);
+        }
+    }
+    free(path_index);
+    free(path_index_value);
+    path_index = NULL;
+    path_index_num = 0;
+    path_index_value = NULL;
+}
+
+// reads executables of directory into its listing, if it has changed since it was last read
+void refresh_path_directory(struct path_directory *directory)
+{
+    struct stat info;
+    struct dir_listing *listing = &directory->listing;
+
+    if (stat(directory->path, &info) == -1 || !S_ISDIR(info.st_mode))
+    {
+        return;
+    }
+    if (directory->is_read && listing->device == info.st_dev && listing->inode == info.st_ino &&
+        listing->mtime.tv_sec == info.st_mtim.tv_sec && listing->mtime.tv_nsec == info.st_mtim.tv_nsec)
+    {
+        return;
+    }
+
+    int fd = open(directory->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    struct dir_listing fresh;
+    if (fd == -1)
+    {
+        return;
+    }
+    if (fstat(fd, &info) == -1 || read_dir_listing(fd, &fresh) == -1)
+    {
+        close(fd);
+        return;
+    }
+
+    // keep only what can be run, entries stay sorted as they are only moved to the front
+    int kept = 0;
+    for (int i = 0; i < fresh.entries_num; i++)
+    {
+        char *name = fresh.names + fresh.entries[i].name_offset;
+        unsigned char type = fresh.entries[i].type;
+        struct stat entry_info;
+
+        if (type != DT_REG && type != DT_LNK && type != DT_UNKNOWN)
+        {
+            continue;
+        }
+        if (type != DT_REG && (fstatat(fd, name, &entry_info, 0) == -1 || !S_ISREG(entry_info.st_mode)))
+        {
+            continue;
+        }
+        if (faccessat(fd, name, X_OK, 0) == 0)
+        {
+            fresh.entries[kept++] = fresh.entries[i];
+        }
+    }
+    close(fd);
+    fresh.entries_num = kept;
+    fresh.device = info.st_dev;
+    fresh.inode = info.st_ino;
+    fresh.mtime = info.st_mtim;
+
+    if (directory->is_read)
+    {
+        free(listing->names);
+        free(listing->entries);
+    }
+    *listing = fresh;
+    directory->is_read = true;
+}
+
+// makes PATH index match PATH, only directories that changed since last time are read again
+// index is shared by threads, shared_paths_lock has to be held
+void refresh_path_index(struct minibash *interpreter)
+{
+    char *value = get_variable(interpreter, "PATH");
+    if (!value)
+    {
+        value = "";
+    }
+
+    if (!path_index_value || strcmp(path_index_value, value) != 0)
+    {
+        free_path_index();
+        path_index_value = strdup(value);
+        for (char *directory = value; directory;)
+        {
+            size_t length = strcspn(directory, ":");
+            path_index = realloc(path_index, sizeof(struct path_directory) * (path_index_num + 1));
+            // empty directory in PATH is current directory
+            path_index[path_index_num].path = length ? strndup(directory, length) : strdup(".");
+            path_index[path_index_num].is_read = false;
+            path_index_num++;
+            directory = directory[length] == ':' ? directory + length + 1 : NULL;
+        }
+    }
+
+    for (int i = 0; i < path_index_num; i++)
+    {
+        refresh_path_directory(&path_index[i]);
+    }
+}
+
+// adds names of sorted listing which start with prefix to matches, each after before
+// hidden names are added only when prefix starts with a dot, directories get a / after them
+void complete_from_listing(struct dir_listing *listing, const char *directory, const char *before, const char *prefix,
+                           struct word_list *matches)
+{
+    size_t length = strlen(prefix);
+    int low = 0, high = listing->entries_num;
+
+    // first entry not less than prefix, everything starting with prefix follows it
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (strcmp(listing->names + listing->entries[middle].name_offset, prefix) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    for (int i = low; i < listing->entries_num; i++)
+    {
+        char *name = listing->names + listing->entries[i].name_offset;
+        if (strncmp(name, prefix, length) != 0)
+        {
+            break;
+        }
+        if (name[0] == '.' && prefix[0] != '.')
+        {
+            continue;
+        }
+
+        struct string_buffer match;
+        string_buffer_init(&match);
+        string_buffer_append(&match, before);
+        string_buffer_append(&match, name);
+
+        unsigned char type = listing->entries[i].type;
+        if (directory && (type == DT_LNK || type == DT_UNKNOWN))
+        {
+            // find out where a link leads only for the few names which match
+            struct string_buffer path;
+            struct stat info;
+            string_buffer_init(&path);
+            string_buffer_append(&path, directory);
+            string_buffer_append_char(&path, '/');
+            string_buffer_append(&path, name);
+            if (stat(path.data, &info) == 0 && S_ISDIR(info.st_mode))
+            {
+                type = DT_DIR;
+            }
+            string_buffer_free(&path);
+        }
+        if (directory && type == DT_DIR)
+        {
+            string_buffer_append_char(&match, '/');
+        }
+        word_list_push(matches, match.data);
+    }
+}
+
+// adds commands starting with prefix to matches, from PATH index and from name table
+void complete_command(struct minibash *interpreter, const char *prefix, struct word_list *matches)
+{
+    size_t length = strlen(prefix);
+
+    pthread_mutex_lock(&shared_paths_lock);
+    refresh_path_index(interpreter);
+    for (int i = 0; i < path_index_num; i++)
+    {
+        if (path_index[i].is_read)
+        {
+            complete_from_listing(&path_index[i].listing, NULL, "", prefix, matches);
+        }
+    }
+    pthread_mutex_unlock(&shared_paths_lock);
+
+    find_name(interpreter, "", 0, false); // makes sure builtins are in name table
+    for (int i = 0; i < interpreter->name_table_buckets; i++)
+    {
+        for (struct name_entry *entry = interpreter->name_table[i]; entry; entry = entry->next)
+        {
+            if ((entry->builtin != -1 || entry->function || entry->alias) && strncmp(entry->name, prefix, length) == 0)
+            {
+                word_list_push(matches, strdup(entry->name));
+            }
+        }
+    }
+}
+
+// adds paths starting with word to matches, from cached listing of directory word is in
+void complete_file(const char *word, struct word_list *matches)
+{
+    char *slash = strrchr(word, '/');
+    char *before = slash ? strndup(word, slash - word + 1) : strdup("");
+    char *directory = slash ? (slash == word ? strdup("/") : strndup(word, slash - word)) : strdup(".");
+
+    struct dir_listing *listing = get_dir_listing(directory);
+    if (listing)
+    {
+        complete_from_listing(listing, directory, before, slash ? slash + 1 : word, matches);
+    }
+    free(before);
+    free(directory);
+}
+
+// shows matches below line, as many in a row as fit in terminal, only part after last / of each
+void show_matches(char **matches, int count)
+{
+    struct winsize size;
+    int width = ioctl(1, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 ? size.ws_col : 80;
+    int longest = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        char *name = matches[i] + strlen(matches[i]);
+        // a directory's / is shown, so its name starts after the / before it
+        name -= name > matches[i] && name[-1] == '/';
+        while (name > matches[i] && name[-1] != '/')
+            name--;
+        if ((int)strlen(name) > longest)
+        {
+            longest = strlen(name);
+        }
+    }
+
+    int columns = width / (longest + 2) > 0 ? width / (longest + 2) : 1;
+    struct string_buffer screen;
+    string_buffer_init(&screen);
+    string_buffer_append(&screen, "\r\n");
+    for (int i = 0; i < count; i++)
+    {
+        char *name = matches[i] + strlen(matches[i]);
+        name -= name > matches[i] && name[-1] == '/';
+        while (name > matches[i] && name[-1] != '/')
+            name--;
+        string_buffer_append(&screen, name);
+        if ((i + 1) % columns == 0 || i + 1 == count)
+        {
+            string_buffer_append(&screen, "\r\n");
+        }
+        else
+        {
+            for (int pad = strlen(name); pad < longest + 2; pad++)
+            {
+                string_buffer_append_char(&screen, ' ');
+            }
+        }
+    }
+    write_all(1, screen.data, screen.length);
+    string_buffer_free(&screen);
+}
+
+// completes word before cursor, a command name at start of a command, a path anywhere else
+// as much as all matches have in common is added, matches are shown when there's nothing to add and show is true
+void complete_line(struct minibash *interpreter, struct string_buffer *line, size_t *cursor, bool show)
+{
+    size_t start = *cursor;
+    while (start > 0 && line->data[start - 1] != ' ')
+        start--;
+
+    size_t before = start;
+    while (before > 0 && line->data[before - 1] == ' ')
+        before--;
+
+    char *word = strndup(line->data + start, *cursor - start);
+    bool is_command = (before == 0 || strchr("|;&", line->data[before - 1])) && !strchr(word, '/');
+    struct word_list matches;
+    word_list_init(&matches);
+
+    if (is_command)
+    {
+        complete_command(interpreter, word, &matches);
+    }
+    else
+    {
+        complete_file(word, &matches);
+    }
+
+    if (matches.count == 0)
+    {
+        write_all(1, "\a", 1);
+        free(word);
+        return;
+    }
+
+    // same name can be in many directories of PATH and be a builtin too
+    qsort(matches.words, matches.count, sizeof(char *), compare_words);
+    int unique = 1;
+    for (int i = 1; i < matches.count; i++)
+    {
+        if (strcmp(matches.words[i], matches.words[unique - 1]) == 0)
+        {
+            free(matches.words[i]);
+        }
+        else
+        {
+            matches.words[unique++] = matches.words[i];
+        }
+    }
+
+    // sorted, so what first and last have in common all of them have
+    char *first = matches.words[0], *last = matches.words[unique - 1];
+    size_t common = 0;
+    while (first[common] && first[common] == last[common])
+        common++;
+
+    size_t word_length = strlen(word);
+    if (common > word_length)
+    {
+        string_buffer_insert(line, *cursor, first + word_length, common - word_length);
+        *cursor += common - word_length;
+    }
+    if (unique == 1 && first[common - 1] != '/')
+    {
+        string_buffer_insert(line, (*cursor)++, " ", 1);
+    }
+    else if (unique > 1 && common <= word_length && show)
+    {
+        show_matches(matches.words, unique);
+    }
+
+    for (int i = 0; i < unique; i++)
+    {
+        free(matches.words[i]);
+    }
+    free(matches.words);
+    free(word);
+}
+
+// LINE EDITOR
+// puts terminal in raw mode, so keys come one by one and aren't echoed
+// returns -1 if terminal can't be changed
+int enable_raw_mode(struct termios *saved)
+{
+    if (tcgetattr(0, saved) == -1)
+    {
+        return -1;
+    }
+
+    struct termios raw = *saved;
+    raw.c_iflag &= ~(ICRNL | IXON);
+    raw.c_lflag &= ~(ECHO | ICANON | ISIG | IEXTEN);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    return tcsetattr(0, TCSADRAIN, &raw);
+}
+
+// returns next key, escape sequences of arrows and others are turned into KEY_*
+// returns -1 on end of input
+int read_key()
+{
+    unsigned char c, sequence[3];
+    ssize_t read_num;
+
+    while ((read_num = read(0, &c, 1)) == -1 && errno == EINTR)
+        ;
+    if (read_num != 1)
+    {
+        return -1;
+    }
+    if (c != '\x1b')
+    {
+        return c;
+    }
+
+    if (read(0, sequence, 2) != 2)
+    {
+        return KEY_UNKNOWN;
+    }
+    if (sequence[0] == '[' && sequence[1] >= '0' && sequence[1] <= '9')
+    {
+        // i.e. ESC [ 3 ~ for delete
+        if (read(0, sequence + 2, 1) != 1 || sequence[2] != '~')
+        {
+            return KEY_UNKNOWN;
+        }
+        switch (sequence[1])
+        {
+        case '1':
+        case '7':
+            return KEY_HOME;
+        case '4':
+        case '8':
+            return KEY_END;
+        case '3':
+            return KEY_DELETE;
+        }
+        return KEY_UNKNOWN;
+    }
+    if (sequence[0] == '[' || sequence[0] == 'O')
+    {
+        switch (sequence[1])
+        {
+        case 'A':
+            return KEY_UP;
+        case 'B':
+            return KEY_DOWN;
+        case 'C':
+            return KEY_RIGHT;
+        case 'D':
+            return KEY_LEFT;
+        case 'H':
+            return KEY_HOME;
+        case 'F':
+            return KEY_END;
+        }
+    }
+    return KEY_UNKNOWN;
+}
+
+// draws prompt and line again, with cursor at cursor
+void refresh_line(const char *prompt, struct string_buffer *line, size_t cursor)
+{
+    struct string_buffer screen;
+    string_buffer_init(&screen);
+    string_buffer_append(&screen, "\r");
+    string_buffer_append(&screen, prompt);
+    string_buffer_append_length(&screen, line->data, line->length);
+    string_buffer_append(&screen, "\x1b[K\r");
+
+    size_t column = strlen(prompt) + cursor;
+    if (column > 0)
+    {
+        char move[32];
+        snprintf(move, sizeof(move), "\x1b[%zuC", column);
+        string_buffer_append(&screen, move);
+    }
+    write_all(1, screen.data, screen.length);
+    string_buffer_free(&screen);
+}
+
+// replaces line with line of history at index, line is left empty if history got shorter meanwhile
+void load_history_line(struct string_buffer *line, int index)
+{
+    string_buffer_clear(line);
+    string_buffer_append(line, "");
+    pthread_mutex_lock(&history_lock);
+    if (index < history_lines_num)
+    {
+        size_t length;
+        char *text = history_line(index, &length);
+        string_buffer_append_length(line, text, length);
+    }
+    pthread_mutex_unlock(&history_lock);
+}
+
+// reads a line from terminal with editing, history and ctrl+r search
+// returns length of line, -1 on end of input
+long edit_line(struct minibash *interpreter, struct string_buffer *line, const char *prompt)
+{
+    struct termios saved;
+    if (enable_raw_mode(&saved) == -1)
+    {
+        printf("%s", prompt);
+        return string_buffer_read_line(line, stdin);
+    }
+
+    struct string_buffer typed, query, search_prompt;
+    string_buffer_init(&typed);
+    string_buffer_init(&query);
+    string_buffer_init(&search_prompt);
+    string_buffer_clear(line);
+    string_buffer_append(line, "");
+
+    size_t cursor = 0;
+    int history_position = -1; // -1 is line being typed, typed keeps it while moving through history
+    bool is_searching = false;
+    int match = -1;
+    long ret_value = 0;
+    bool is_done = false;
+    int last_key = -1; // second tab in a row shows matches
+
+    refresh_line(prompt, line, cursor);
+    while (!is_done)
+    {
+        int key = read_key();
+        int previous_key = last_key;
+        last_key = key;
+
+        if (is_searching)
+        {
+            int found = -2;
+            if (key >= ' ' && key < 127)
+            {
+                // look for longer query starting from current match
+                string_buffer_append_char(&query, key);
+                found = find_history(query.data, query.length, match == -1 ? history_lines_num - 1 : match, -1, false, NULL);
+            }
+            else if (key == CTRL('R'))
+            {
+                found = find_history(query.data, query.length, match == -1 ? history_lines_num - 1 : match - 1, -1, false, NULL);
+            }
+            else if (key == 127 || key == CTRL('H'))
+            {
+                if (query.length > 0)
+                {
+                    string_buffer_erase(&query, query.length - 1, 1);
+                }
+                found = find_history(query.data, query.length, history_lines_num - 1, -1, false, NULL);
+            }
+            else if (key == CTRL('G') || key == CTRL('C'))
+            {
+                // give up search, line is back to what it was
+                is_searching = false;
+                string_buffer_clear(line);
+                string_buffer_append_length(line, typed.data, typed.length);
+                cursor = line->length;
+                refresh_line(prompt, line, cursor);
+                continue;
+            }
+            else
+            {
+                // any other key takes match and is handled as usual
+                is_searching = false;
+            }
+
+            if (is_searching)
+            {
+                if (found >= 0)
+                {
+                    match = found;
+                    load_history_line(line, match);
+                    cursor = (char *)memmem(line->data, line->length, query.data, query.length) - line->data;
+                }
+                string_buffer_clear(&search_prompt);
+                string_buffer_append(&search_prompt, found == -1 ? "(failed reverse-i-search)`" : "(reverse-i-search)`");
+                string_buffer_append_length(&search_prompt, query.data, query.length);
+                string_buffer_append(&search_prompt, "': ");
+                refresh_line(search_prompt.data, line, cursor);
+                continue;
+            }
+            history_position = match;
+            refresh_line(prompt, line, cursor);
+        }
+
+        switch (key)
+        {
+        case -1:
+            ret_value = -1;
+            is_done = true;
+            break;
+        case '\r':
+        case '\n':
+            is_done = true;
+            break;
+        case CTRL('D'):
+            // ctrl+d on an empty line is end of input
+            if (line->length == 0)
+            {
+                ret_value = -1;
+                is_done = true;
+            }
+            else if (cursor < line->length)
+            {
+                string_buffer_erase(line, cursor, 1);
+            }
+            break;
+        case CTRL('C'):
+            write_all(1, "^C\r\n", 4);
+            string_buffer_clear(line);
+            cursor = 0;
+            history_position = -1;
+            break;
+        case 127:
+        case CTRL('H'):
+            if (cursor > 0)
+            {
+                string_buffer_erase(line, --cursor, 1);
+            }
+            break;
+        case KEY_DELETE:
+            if (cursor < line->length)
+            {
+                string_buffer_erase(line, cursor, 1);
+            }
+            break;
+        case KEY_LEFT:
+        case CTRL('B'):
+            cursor -= cursor > 0;
+            break;
+        case KEY_RIGHT:
+        case CTRL('F'):
+            cursor += cursor < line->length;
+            break;
+        case KEY_HOME:
+        case CTRL('A'):
+            cursor = 0;
+            break;
+        case KEY_END:
+        case CTRL('E'):
+            cursor = line->length;
+            break;
+        case CTRL('K'):
+            string_buffer_erase(line, cursor, line->length - cursor);
+            break;
+        case CTRL('U'):
+            string_buffer_erase(line, 0, cursor);
+            cursor = 0;
+            break;
+        case CTRL('W'):
+        {
+            size_t start = cursor;
+            while (start > 0 && line->data[start - 1] == ' ')
+                start--;
+            while (start > 0 && line->data[start - 1] != ' ')
+                start--;
+            string_buffer_erase(line, start, cursor - start);
+            cursor = start;
+            break;
+        }
+        case CTRL('L'):
+            write_all(1, "\x1b[H\x1b[2J", 7);
+            break;
+        case '\t':
+            complete_line(interpreter, line, &cursor, previous_key == '\t');
+            break;
+        case KEY_UP:
+        case CTRL('P'):
+        case KEY_DOWN:
+        case CTRL('N'):
+        {
+            // what was typed before moving through history is a prefix lines have to start with
+            bool is_up = key == KEY_UP || key == CTRL('P');
+            if (history_position == -1)
+            {
+                if (!is_up)
+                {
+                    break;
+                }
+                string_buffer_clear(&typed);
+                string_buffer_append_length(&typed, line->data, line->length);
+                pthread_mutex_lock(&history_lock);
+                refresh_history(interpreter);
+                pthread_mutex_unlock(&history_lock);
+            }
+
+            int start = history_position == -1 ? history_lines_num - 1 : history_position + (is_up ? -1 : 1);
+            int found = find_history(typed.data, typed.length, start, is_up ? -1 : 1, true, line->data);
+            if (found != -1)
+            {
+                history_position = found;
+                load_history_line(line, found);
+            }
+            else if (!is_up)
+            {
+                history_position = -1;
+                string_buffer_clear(line);
+                string_buffer_append_length(line, typed.data, typed.length);
+            }
+            cursor = line->length;
+            break;
+        }
+        case CTRL('R'):
+            string_buffer_clear(&typed);
+            string_buffer_append_length(&typed, line->data, line->length);
+            string_buffer_clear(&query);
+            string_buffer_append(&query, "");
+            pthread_mutex_lock(&history_lock);
+            refresh_history(interpreter);
+            pthread_mutex_unlock(&history_lock);
+            is_searching = true;
+            match = -1;
+            refresh_line("(reverse-i-search)`': ", line, cursor);
+            continue;
+        default:
+            if (key >= ' ' && key < 256 && key != 127)
+            {
+                char c = key;
+                string_buffer_insert(line, cursor++, &c, 1);
+            }
+            break;
+        }
+
+        if (!is_done)
+        {
+            refresh_line(prompt, line, cursor);
+        }
+    }
+
+    write_all(1, "\r\n", 2);
+    tcsetattr(0, TCSADRAIN, &saved);
+    string_buffer_free(&typed);
+    string_buffer_free(&query);
+    string_buffer_free(&search_prompt);
+    return ret_value == -1 ? -1 : (long)line->length;
+}
+
+// reads a line of input after showing prompt, with line editor and history when input is a terminal
+// returns -1 on end of input
+long read_input_line(struct minibash *interpreter, struct string_buffer *input, const char *prompt)
+{
+    if (!isatty(0) || !isatty(1))
+    {
+        printf("%s", prompt);
+        return string_buffer_read_line(input, stdin);
+    }
+
+    fflush(stdout);
+    long length = edit_line(interpreter, input, prompt);
+    if (length > 0)
+    {
+        add_history(interpreter, input->data);
+    }
+    return length;
+}
+
+// returns length of here document operator at c, 2 for <<, 3 for <<< here string, 0 if there's none
+// like in bash it needs no space before it, cat<<EOF is a here document too, reading bodies and parsing
+// both find operators with this so they agree on which <<WORD a body belongs to
+int here_document_operator(const char *c)
+{
+    if (c[0] != '<' || c[1] != '<')
+    {
+        return 0;
+    }
+    return c[2] == '<' ? 3 : 2;
+}
+
+// returns length of file name, fd or here document word after a redirection operator at word,
+// it ends at a space or at a special character, so cat <<<a; cat <<<b is two commands
+size_t redirection_word_length(const char *word)
+{
+    return strcspn(word, " ;|&<>");
+}
+
+// reads bodies of here documents <<WORD of input, lines up to one that is WORD, from file or from terminal
+// bodies are kept out of buffer input was read into, which is reused for every line and would stay as big as
+// the biggest payload, add_script_line puts them after their input, each after a HERE_DOCUMENT_MARKER,
+// so they travel with it wherever it goes, a loop, a function or a plan, and are taken out again when it's parsed
+// returns bodies, NULL if input has no here documents
+char *read_here_documents(struct minibash *interpreter, const char *input, FILE *file)
+{
+    struct string_buffer bodies, line;
+    string_buffer_init(&bodies);
+    string_buffer_init(&line);
+
+    for (const char *c = strstr(input, "<<"); c; c = strstr(c + here_document_operator(c), "<<"))
+    {
+        // <<< is a here string and has no body
+        if (here_document_operator(c) == 3)
+        {
+            continue;
+        }
+
+        const char *word = c + 2 + strspn(c + 2, " ");
+        size_t length = redirection_word_length(word);
+        if (length >= 2 && (word[0] == '\'' || word[0] == '"') && word[length - 1] == word[0])
+        {
+            word++;
+            length -= 2;
+        }
+
+        string_buffer_append_char(&bodies, HERE_DOCUMENT_MARKER);
+        while ((file ? string_buffer_read_line(&line, file) : read_input_line(interpreter, &line, "> ")) != -1 &&
+               !(line.length == length && strncmp(line.data, word, length) == 0))
+        {
+            string_buffer_append_length(&bodies, line.data, line.length);
+            string_buffer_append_char(&bodies, '\n');
+        }
+    }
+
+    string_buffer_free(&line);
+    return bodies.data;
+}
+
+// INSTANCES
+// locks or unlocks byte of slot in registry, or tells if another instance holds it when command is F_OFD_GETLK
+// returns -1 on error
+int lock_registry_slot(int command, short type, int slot)
+{
+    struct flock lock = {0};
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = slot;
+    lock.l_len = 1;
+    // locks of open file descriptions, not of processes, so they are released only when this instance exits
+    if (fcntl(registry_fd, command, &lock) == -1)
+    {
+        return -1;
+    }
+    return command == F_OFD_GETLK ? lock.l_type != F_UNLCK : 0;
+}
+
+// adds this instance to registry of instances of user, takes first slot nobody holds
+// a registry another user made first isn't used, whoever made it could put pids there for dtex to kill
+// returns -1 if there is no registry or no free slot
+int register_instance()
+{
+    char name[64];
+    struct stat info;
+    snprintf(name, sizeof(name), "/minibash-%d", (int)getuid());
+
+    // shm_open sets close on exec, so commands don't keep slot of minibash held
+    registry_fd = shm_open(name, O_RDWR | O_CREAT, 0600);
+    if (registry_fd == -1)
+    {
+        return -1;
+    }
+    if (fstat(registry_fd, &info) == -1 || !S_ISREG(info.st_mode) || info.st_uid != getuid() ||
+        (info.st_mode & 07777) != 0600)
+    {
+        printf("minibash: /dev/shm%s isn't owned by this user with mode 600, instances aren't registered\n", name);
+        close(registry_fd);
+        registry_fd = -1;
+        return -1;
+    }
+    if (ftruncate(registry_fd, sizeof(pid_t) * REGISTRY_SLOTS) == -1)
+    {
+        close(registry_fd);
+        registry_fd = -1;
+        return -1;
+    }
+    registry = mmap(NULL, sizeof(pid_t) * REGISTRY_SLOTS, PROT_READ | PROT_WRITE, MAP_SHARED, registry_fd, 0);
+    if (registry == MAP_FAILED)
+    {
+        registry = NULL;
+        close(registry_fd);
+        registry_fd = -1;
+        return -1;
+    }
+
+    for (int i = 0; i < REGISTRY_SLOTS; i++)
+    {
+        if (lock_registry_slot(F_OFD_SETLK, F_WRLCK, i) == 0)
+        {
+            registry_slot = i;
+            registry[i] = getpid();
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// returns pid of instance registered in slot, 0 if slot is free or is this instance
+pid_t registered_instance(int slot)
+{
+    if (slot == registry_slot || registry[slot] == 0)
+    {
+        return 0;
+    }
+    // only slots with a pid are asked about, so looking through registry takes few system calls
+    return lock_registry_slot(F_OFD_GETLK, F_WRLCK, slot) == 1 ? registry[slot] : 0;
+}
+
+// sends signal to every other instance of user, or only to pid if it's not 0
+// returns number of instances signalled
+int signal_instances(int signal, pid_t pid)
+{
+    int signalled = 0;
+    for (int i = 0; registry && i < REGISTRY_SLOTS; i++)
+    {
+        pid_t instance = registered_instance(i);
+        if (instance != 0 && (pid == 0 || instance == pid) && kill(instance, signal) == 0)
+        {
+            signalled++;
+        }
+    }
+    return signalled;
+}
+
+// for instances
+// instances lists running minibash instances of user, instances kill [-SIGNAL] [PID] signals them
+// SIGTERM is sent when no signal is given, every other instance gets it when no pid is given
+// returns 0 on success, -1 on error
+int instances_command(char *command[])
+{
+    if (registry == NULL)
+    {
+        printf("instances: no registry of instances\n");
+        return -1;
+    }
+
+    if (command[1] == NULL)
+    {
+        printf("%d (this one)\n", getpid());
+        for (int i = 0; i < REGISTRY_SLOTS; i++)
+        {
+            pid_t instance = registered_instance(i);
+            if (instance != 0)
+            {
+                printf("%d\n", instance);
+            }
+        }
+        return 0;
+    }
+
+    if (strcmp(command[1], "kill") != 0)
+    {
+        printf("instances: usage: instances [kill [-SIGNAL] [PID]]\n");
+        return -1;
+    }
+
+    int signal = SIGTERM, argument = 2;
+    char *end;
+    if (command[argument] && command[argument][0] == '-')
+    {
+        signal = strtol(command[argument] + 1, &end, 10);
+        if (*end != '\0' || signal <= 0 || signal >= NSIG)
+        {
+            printf("instances: %s: invalid signal\n", command[argument]);
+            return -1;
+        }
+        argument++;
+    }
+
+    pid_t pid = 0;
+    if (command[argument])
+    {
+        pid = strtol(command[argument], &end, 10);
+        if (*end != '\0' || pid <= 0)
+        {
+            printf("instances: %s: invalid pid\n", command[argument]);
+            return -1;
+        }
+    }
+
+    if (signal_instances(signal, pid) == 0 && pid != 0)
+    {
+        printf("instances: %d: no such minibash instance\n", pid);
+        return -1;
+    }
+    return 0;
+}
+
+// PART 1: Take Input, Parse Input -  Functions
+// removes trailing or leading whitespaces
+// replaces tabspaces in between with whitespace
+// works in a single pass over input and updates input's length
+void fix_input(struct string_buffer *input)
+{
+    char *data = input->data;
+    size_t start = 0, end = input->length;
+
+    // skip leading whitespaces and tabs
+    while (start < end && (data[start] == ' ' || data[start] == '\t'))
+    {
+        start++;
+    }
+
+    // skip trailing whitespaces and tabs
+    while (end > start && (data[end - 1] == ' ' || data[end - 1] == '\t'))
+    {
+        end--;
+    }
+
+    // shift the string left and replace tabspaces with whitespaces
+    size_t j = 0;
+    for (size_t i = start; i < end; i++)
+    {
+        data[j++] = data[i] == '\t' ? ' ' : data[i];
+    }
+
+    input->length = j;
+    data[j] = '\0';
+}
+
+// this function will check input and validate that it only has characters minibash understands, printable ascii but %
+// looked up with strspn, compiling a regex for this took longer than starting minibash
+// returns -1 if not valid, returns 1 if valid
+int check_input(char *input)
+{
+    const char *allowed = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+                          " !\"#$&'()*+,-./:;<=>?@[\\]^_`{|}~";
+
+    return input[strspn(input, allowed)] == '\0' ? 1 : -1;
+}
+
+// this function will validate that there's no different special characters before or after a ">>", "||" OR "&&" is found
+// skip index will skip to check the index in special_char array along with selected_special_character to find special character
+// returns -1 if there are different special characters than the one that has already been selected
+// returns 1 if there's no other special characters found
+int validate_special_char_singularity(char *input, int skip_index)
+{ // special characters after selected_special_char
+    // copy input and skip till first instance of selected_special_char
+    char *input_1 = input;
+    input_1 = strstr(input_1, special_chars[selected_special_char]); // find first instance of selected_special_char
+    input_1 = input_1 + 2;                                           // skip 2 chars from the found index (2 because this function will only be used when selected_special_char == >> or && or ||)
+
+    // loop over to find any special character element before selected_special_char
+    for (int i = 0; i < 10 && i != selected_special_char && i != skip_index; i++)
+    {
+        char *p = strstr(input_1, special_chars[i]);
+
+        if (p != NULL)
+        {
+            // i = 7 i.e. |, selected_special_char = 9 i.e. ||
+            if (selected_special_char == 9 && i == 7)
+            {
+
+                int position = p - input_1;
+                // if || is found after || allow it
+                if (input_1[position + 1] == special_chars[i][0])
+                {
+                    continue;
+                }
+            }
+            printf("Can't have '%s' before %s \n", special_chars[selected_special_char], special_chars[i]);
+            return -1;
+        }
+    }
+
+    // any special characters before selected_special_char
+    char *input_2 = input;
+    input_2 = strstr(input_2, special_chars[selected_special_char]); // find first instance of selected_special_char
+
+    int position = input_2 - input; // get index of first instance of selected_special_char
+
+    // get substring before the first apperance of selected_special_char
+    // strndup terminates it, strncpy left it without a '\0' for strstr to stop at
+    char *input_3 = strndup(input, position > 0 ? position - 1 : 0);
+
+    // loop over to find any other special character element after selected_special_char
+    for (int i = 0; i < 10 && i != selected_special_char && i != skip_index; i++)
+    {
+        if (strstr(input_3, special_chars[i]) != NULL)
+        {
+            printf("Can't have special character '%s' after %s \n", special_chars[selected_special_char], special_chars[i]);
+            free(input_3);
+            return -1;
+        }
+    }
+    free(input_3);
+    return 1; // if program is here it means that no other special characters have been found
+}
+
+// find which special character is being used and checks that there are no other special characters except for conditionals
+// associated with checking the syntax
+// check if there aren't any 2 different special characters except for conditionals
+// returns -1 if special char exists and has error
+// returns 1 if special char does not exists
+int find_special_char(char *input)
+{
+    // reset bools and vars
+    selected_special_char = -1;
+    is_conditional = false;
+    is_special_char = false;
+    is_multiple_conditional = false;
+
+    int diff_special_char = 0;
+
+    // find selected_special_char
+    for (int i = 0; i < 10; i++)
+    {
+        if (strstr(input, special_chars[i]) != NULL)
+        {
+            selected_special_char = i;
+            is_special_char = true;
+            diff_special_char += 1; // increment diff counter
+        }
+    }
+
+    // if conditional i.e. && or || then set boolean to be true
+    if (selected_special_char >= 8)
+    {
+        is_conditional = true;
+
+        // validates that there is no other special characters than && || in any scenario
+        if (selected_special_char == 8)
+        {
+            return validate_special_char_singularity(input, 9); // skip = 9 because for &&, || is allowed
+        }
+        else
+        {
+            return validate_special_char_singularity(input, 8); // skip = 8 because for ||, && is allowed
+        }
+    }
+
+    // to check if any special characters before and after
+    else if (selected_special_char == 4)
+    {
+        // validates that there is only 1 kind of special character
+        return validate_special_char_singularity(input, selected_special_char);
+    }
+
+    // for non conditional statements, check if there are more than 1 different special characters
+    else if (!is_conditional && diff_special_char > 1)
+    {
+        printf("Can't have more than 1 different special character in a statement\n");
+        return -1;
+    }
+
+    return 1;
+}
+
+// used in validate_special_char
+// find special_char_num for a selected special character
+int find_all_special_chars(char *input)
+{
+    char *p = input;
+
+    int length = strlen(special_chars[selected_special_char]);
+
+    // reset
+    special_char_num = 0;
+
+    // keep incrementing p by special char length as it's being found
+    while ((p = strstr(p, special_chars[selected_special_char])) != NULL)
+    {
+
+        special_char_num += 1;
+        p += length;
+    }
+
+    return special_char_num;
+}
+
+// validate for each special character that other special characters doesn't exist and
+// number of any given special characters are less than 3
+// returns delimiter for tokenization
+char *validate_special_char(char *input, size_t length, char *delimiters)
+{
+    int ret_value;
+
+    // according to selected_special_char, make delimiters
+    if (selected_special_char >= 0 && selected_special_char <= 4)
+    {
+        // for #,+,<,>,>>
+        ret_value = find_all_special_chars(input);
+        if (ret_value == 1)
+        {
+            strcpy(delimiters, special_chars[selected_special_char]);
+        }
+        else
+        {
+            printf("Program Only supports upto 1 operation for %s special character\n", special_chars[selected_special_char]);
+            return NULL;
+        }
+    }
+    else if (selected_special_char >= 5 && selected_special_char <= 7)
+    {
+        // for ~ ; |
+
+        ret_value = find_all_special_chars(input);
+
+        if (ret_value >= 1 && ret_value <= 3)
+        {
+            strcat(delimiters, special_chars[selected_special_char]);
+        }
+        else
+        {
+            printf("Program Only supports upto 3 operations for %s special character\n", special_chars[selected_special_char]);
+            return NULL;
+        }
+    }
+    else
+    {
+        // for &&, ||
+
+        // value 1 & 2 will have the number of times && and || occur in input
+
+        // value 1 is the count of original selected character
+        // value 2 is the count of the other special character which is allowed
+
+        int value_1, value_2;
+        value_1 = find_all_special_chars(input);
+
+        // change special selected character
+        if (selected_special_char == 8)
+            selected_special_char = 9;
+        else
+            selected_special_char = 8;
+
+        value_2 = find_all_special_chars(input);
+        ret_value = value_1 + value_2;
+        special_char_num = ret_value;
+
+        // change it back to original
+        if (selected_special_char == 8)
+            selected_special_char = 9;
+        else
+            selected_special_char = 8;
+
+        if (ret_value <= 3 && ret_value > 0)
+        {
+            strcpy(delimiters, special_chars[8]);
+            strcat(delimiters, special_chars[9]);
+        }
+        else
+        {
+            printf("Program Only supports upto 3 operations for || and && special characters\n");
+            return NULL;
+        }
+
+        if (value_2 > 0)
+        {
+            is_multiple_conditional = true;
+            // if there are multiple conditions, there are at most 3 conditionals possible acc to rules
+            // 2^3 = 8 permuations possible for 2 characters
+
+            // becaus of is_special_char array order,
+            // value 1 will always represent no of || characters
+            // value 2 will always represent no of && characters
+
+            // walk input once and record the order in which && and || appear
+            int i = 0;
+            for (size_t k = 0; k + 1 < length && i < ret_value; k++)
+            {
+                if (input[k] == '&' && input[k + 1] == '&')
+                {
+                    multiple_conditionals_sequence[i++] = false;
+                    k++;
+                }
+                else if (input[k] == '|' && input[k + 1] == '|')
+                {
+                    multiple_conditionals_sequence[i++] = true;
+                    k++;
+                }
+            }
+        }
+    }
+
+    return delimiters;
+}
+
+// adds a redirection of command to redirections
+// returns -1 if there are too many redirections
+int add_redirection(int command, int kind, int fd, int source_fd, int flags, char *path)
+{
+    if (redirections_num == MAX_REDIRECTIONS)
+    {
+        printf("Program Only supports upto %d redirections in an input\n", MAX_REDIRECTIONS);
+        free(path);
+        return -1;
+    }
+
+    redirections[redirections_num].kind = kind;
+    redirections[redirections_num].fd = fd;
+    redirections[redirections_num].source_fd = source_fd;
+    redirections[redirections_num].flags = flags;
+    redirections[redirections_num].path = path;
+    redirections[redirections_num].command = command;
+    redirections_num++;
+    return 1;
+}
+
+// makes redirections of command the only ones applied, in the order they were written
+// others are dropped without being freed, whoever selects keeps a copy of all of them to put back
+void select_redirections(int command)
+{
+    int selected_num = 0;
+    for (int i = 0; i < redirections_num; i++)
+    {
+        if (redirections[i].command == command)
+        {
+            redirections[selected_num++] = redirections[i];
+        }
+    }
+    redirections_num = selected_num;
+}
+
+// finds standard error redirections 2>, 2>>, 2>&1, &>, &>> and here documents <<WORD, <<< word in input
+// and removes them from it, bodies of here documents are taken one by one from here_documents
+// they are stored in redirections so that they can be applied in child after fork,
+// remaining input is then parsed like before, so these can be used with any special character
+// an operator is only recognised at start of a word, so a2>b is left as it is
+// each redirection belongs to command it's written in, counted by the ;, |, && and || before it
+// returns -1 on error, returns 1 on success
+int extract_redirections(struct string_buffer *input_buffer, char **here_documents)
+{
+    char *input = input_buffer->data;
+    size_t length = input_buffer->length;
+    size_t i = 0, j = 0;
+    bool is_position_found = false;
+    int command = 0;
+
+    while (i < length)
+    {
+        bool word_start = (i == 0 || input[i - 1] == ' ');
+        int operator_length = 0;
+        int fd = 2;
+        int flags = 0;
+
+        // N>&M needs no file, fd N becomes a copy of fd M, stdout when N isn't given, i.e. 2>&1 and >&2
+        size_t fd_digits = word_start && input[i] >= '0' && input[i] <= '9';
+        if (word_start && strncmp(input + i + fd_digits, ">&", 2) == 0)
+        {
+            size_t source_start = i + fd_digits + 2;
+            size_t source_end = source_start;
+            while (source_end < length && input[source_end] >= '0' && input[source_end] <= '9')
+            {
+                source_end++;
+            }
+            if (source_end == source_start || source_end != source_start + redirection_word_length(input + source_start))
+            {
+                printf("Provide the file descriptor you want to copy, after '%.*s'\n", (int)(fd_digits + 2), input + i);
+                return -1;
+            }
+            int target_fd = fd_digits ? input[i] - '0' : 1;
+            if (add_redirection(command, FD_ACTION_DUP, target_fd, atoi(input + source_start), 0, NULL) == -1)
+            {
+                return -1;
+            }
+            i = source_end;
+            continue;
+        }
+        else if (word_start && strncmp(input + i, "2>>", 3) == 0)
+        {
+            operator_length = 3;
+            flags = O_WRONLY | O_CREAT | O_APPEND;
+        }
+        else if (word_start && strncmp(input + i, "2>", 2) == 0)
+        {
+            operator_length = 2;
+            flags = O_WRONLY | O_CREAT | O_TRUNC;
+        }
+        else if (word_start && strncmp(input + i, "&>>", 3) == 0)
+        {
+            operator_length = 3;
+            fd = 1;
+            flags = O_WRONLY | O_CREAT | O_APPEND;
+        }
+        else if (word_start && strncmp(input + i, "&>", 2) == 0)
+        {
+            operator_length = 2;
+            fd = 1;
+            flags = O_WRONLY | O_CREAT | O_TRUNC;
+        }
+        else if (here_document_operator(input + i))
+        {
+            operator_length = here_document_operator(input + i);
+            fd = 0;
+        }
+
+        // not a redirection, keep character
+        if (operator_length == 0)
+        {
+            // first < or > left in input is the one redirect_and_run does, after redirections written before it
+            if (!is_position_found && (input[i] == '<' || input[i] == '>'))
+            {
+                redirection_position = redirections_num;
+                is_position_found = true;
+            }
+            // && and || are one separator
+            if (input[i] == ';' || input[i] == '|' || (input[i] == '&' && input[i + 1] == '&'))
+            {
+                command++;
+                if (input[i] != ';' && input[i + 1] == input[i])
+                {
+                    input[j++] = input[i++];
+                }
+            }
+            input[j++] = input[i++];
+            continue;
+        }
+
+        // find the file name after operator
+        size_t name_start = i + operator_length;
+        while (name_start < length && input[name_start] == ' ')
+        {
+            name_start++;
+        }
+        size_t name_end = name_start + redirection_word_length(input + name_start);
+
+        if (name_end == name_start)
+        {
+            printf("Provide the file name you want to redirect to, after '%.*s'\n", operator_length, input + i);
+            return -1;
+        }
+
+        char *path = strndup(input + name_start, name_end - name_start);
+        if (fd == 0)
+        {
+            // <<< word is word on a line of its own, <<WORD is next body, 'WORD' keeps $ in body as it is
+            bool is_literal = path[0] == '\'' || path[0] == '"';
+            if (operator_length == 3)
+            {
+                path = realloc(path, strlen(path) + 2);
+                strcat(path, "\n");
+            }
+            else
+            {
+                free(path);
+                char *body = *here_documents ? *here_documents + 1 : "";
+                char *next = *here_documents ? strchr(body, HERE_DOCUMENT_MARKER) : NULL;
+                path = next ? strndup(body, next - body) : strdup(body);
+                *here_documents = next;
+            }
+            if (add_redirection(command, FD_ACTION_DATA, 0, -1, !is_literal, path) == -1)
+            {
+                return -1;
+            }
+            i = name_end;
+            continue;
+        }
+
+        if (add_redirection(command, FD_ACTION_OPEN, fd, -1, flags, path) == -1)
+        {
+            return -1;
+        }
+
+        // &> sends both stdout and stderr to the file
+        if (fd == 1 && add_redirection(command, FD_ACTION_DUP, 2, 1, 0, NULL) == -1)
+        {
+            return -1;
+        }
+
+        i = name_end;
+    }
+
+    input_buffer->length = j;
+    input[j] = '\0';
+    return 1;
+}
+
+// finds process substitutions <(cmd) and >(cmd) in input and replaces each with a marker
+// the command inside can use any special character, so they are taken out before anything else
+// markers are swapped with /dev/fd/N paths once the commands are started, see start_substitutions
+// returns -1 on error, returns 1 on success
+int extract_process_substitutions(struct string_buffer *input_buffer)
+{
+    char *input = input_buffer->data;
+    size_t length = input_buffer->length;
+    size_t i = 0, j = 0;
+
+    while (i < length)
+    {
+        bool word_start = (i == 0 || input[i - 1] == ' ');
+
+        // <(cmd) inside $(...) belongs to command of $(...), it's found when that command runs
+        if (input[i] == '`' || (input[i] == '$' && input[i + 1] == '('))
+        {
+            char *end = command_substitution_end(input + i);
+            size_t substitution_end = end ? (size_t)(end - input) : length;
+            while (i < substitution_end)
+            {
+                input[j++] = input[i++];
+            }
+            continue;
+        }
+
+        if (!word_start || i + 1 >= length || input[i + 1] != '(' || (input[i] != '<' && input[i] != '>'))
+        {
+            input[j++] = input[i++];
+            continue;
+        }
+
+        // find matching bracket
+        size_t end = i + 2;
+        int depth = 1;
+        while (end < length && depth > 0)
+        {
+            if (input[end] == '(')
+                depth++;
+            else if (input[end] == ')')
+                depth--;
+            end++;
+        }
+
+        if (depth != 0)
+        {
+            printf("Syntax Error, missing ')' after '%c('\n", input[i]);
+            return -1;
+        }
+
+        if (substitutions_num == MAX_SUBSTITUTIONS)
+        {
+            printf("Program Only supports upto %d process substitutions in an input\n", MAX_SUBSTITUTIONS);
+            return -1;
+        }
+
+        struct process_substitution *substitution = &substitutions[substitutions_num];
+        substitution->command = strndup(input + i + 2, end - i - 3);
+        substitution->is_output = input[i] == '>';
+        substitution->fd = -1;
+        substitution->pid = -1;
+
+        input[j++] = SUBSTITUTION_MARKER;
+        input[j++] = '0' + substitutions_num;
+        substitutions_num++;
+
+        i = end;
+    }
+
+    input_buffer->length = j;
+    input[j] = '\0';
+    return 1;
+}
+
+// parses input and validates that the input is according to the required rules
+// returns null on error
+// returns delimiters on success
+char *input_parsing(struct string_buffer *input_buffer)
+{
+    if (input_buffer->length == 0)
+    {
+        return NULL;
+    }
+
+    // bodies of here documents aren't input to parse, they are taken by their <<WORD
+    char *here_documents = NULL;
+    char *marker = strchr(input_buffer->data, HERE_DOCUMENT_MARKER);
+    if (marker)
+    {
+        here_documents = strdup(marker);
+        *marker = '\0';
+        input_buffer->length = marker - input_buffer->data;
+    }
+
+    fix_input(input_buffer); // fix input to fit regular expression
+
+    if (input_buffer->length == 0)
+    {
+        free(here_documents);
+        return NULL;
+    }
+
+    char *input = input_buffer->data;
+
+    // only characters minibash understands
+    if (check_input(input) == -1)
+    {
+        printf("Invalid Input, try again!\n");
+        free(here_documents);
+        return NULL;
+    }
+
+    // take out process substitutions first, commands inside them have their own special characters
+    if (extract_process_substitutions(input_buffer) == -1)
+    {
+        free(here_documents);
+        return NULL;
+    }
+
+    // so do commands of $(cmd) and `cmd`, which stay in their word and run when it's expanded
+    if (hide_command_substitutions(input_buffer->data) == -1)
+    {
+        free(here_documents);
+        return NULL;
+    }
+
+    // take out stderr redirections and here documents before looking for special characters,
+    // since they contain >, & and <
+    char *next_here_document = here_documents;
+    int ret_value = extract_redirections(input_buffer, &next_here_document);
+    free(here_documents);
+    if (ret_value == -1)
+    {
+        return NULL;
+    }
+
+    // find what special character is being used
+    if (find_special_char(input) == -1)
+    {
+        return NULL;
+    }
+
+    if (selected_special_char > -1)
+    {
+
+        // add delimiters according to the option
+        // "&&" and "||" together is the longest set of delimiters
+        char *delimiters = malloc(sizeof(char) * 5);
+        delimiters[0] = '\0';
+
+        // validate input for each special character and return delimiters, which are only kept if it's valid
+        if (validate_special_char(input, input_buffer->length, delimiters) == NULL)
+        {
+            free(delimiters);
+            return NULL;
+        }
+        return delimiters;
+    }
+    else
+    {
+        return default_delimiters;
+    }
+}
+
+// PART 2: Tokenization & Identification of Commands & it's parameters -  Functions
+
+// will find tokens for given delimiters and change result
+// used in tokenize_commands
+// index when called in a loop, when there are multiple commands
+// result is a new NULL terminated array with a copy of each token
+// timeout, retry and limit in front of a command and their argument don't count towards MAX_PARAMETERS
+// returns the number of tokens found on success
+// returns -1 if tokens go beyond
+int find_tokens(char *string, char *delimiters, char ***result, int index)
+{
+    int tokens_cnt = 0;
+    int prefix_words = 0;
+    int capacity = MAX_PARAMETERS + 2;
+    char *token, *position;
+    char **tokens = malloc(sizeof(char *) * capacity);
+
+    tokens[0] = NULL;
+    *result = tokens;
+
+    // initalize all_command_pointer's index according to commands
+    if (index != -1)
+    {
+        all_commands_pointer[index] = tokens;
+    }
+
+    // Tokenize via default Delimiters and find arguments of that command
+    for (token = strtok_r(string, delimiters, &position); token; token = strtok_r(NULL, delimiters, &position))
+    {
+        // if at any point number of tokens are more than 4, return -1 as error
+        if (tokens_cnt - prefix_words > MAX_PARAMETERS)
+        {
+            return -1;
+        }
+
+        // a prefix and its argument, i.e. timeout 5, are put in front of a command of up to 4 words
+        if (tokens_cnt == prefix_words &&
+            (strcmp(token, "timeout") == 0 || strcmp(token, "retry") == 0 || strcmp(token, "limit") == 0))
+        {
+            prefix_words += 2;
+        }
+        if (tokens_cnt + 2 > capacity)
+        {
+            capacity *= 2;
+            tokens = realloc(tokens, sizeof(char *) * capacity);
+            *result = tokens;
+            if (index != -1)
+            {
+                all_commands_pointer[index] = tokens;
+            }
+        }
+
+        // copy token to command
+        tokens[tokens_cnt++] = strdup(token);
+        tokens[tokens_cnt] = NULL;
+    }
+
+    return tokens_cnt;
+}
+
+// tokenizes commands and puts into command_1,2,3,4 according to number of special chars in input
+// words are left as typed, expand_commands expands them right before commands run
+// returns -1, if no of parameters exceed beyond 3
+// returns 1 on success
+int tokenize_commands(char *input, char *custom_delimiters)
+{
+    int ret_value = 1;
+    char *input_backup = strdup(input); // backup of input after parsing
+
+    if (is_special_char)
+    {
+        // find tokens according to default
+        // get all commands in input string which are divided by custom_delimiters i.e. recieved from input_parsing indicating that special_char exists
+        if (find_tokens(input_backup, custom_delimiters, &all_commands, -1) == -1)
+        {
+            free(input_backup);
+            return -1;
+        }
+
+        // initalize all_commands_pointers, commands which are never found stay empty
+        all_commands_pointer = calloc(5, sizeof(char **));
+        for (int i = 0; i <= special_char_num && i < 4; i++)
+        {
+            all_commands_pointer[i] = empty_command;
+        }
+
+        int i;
+        char ***commands[] = {&command_1, &command_2, &command_3, &command_4};
+        // tokenize all commands into individual commands
+        for (i = 0; i < special_char_num + 1 && i < 4; i++)
+        {
+            if (all_commands[i] == NULL)
+            {
+                // i.e. nothing after last special character
+                all_commands_pointer[i] = empty_command;
+                break;
+            }
+            if (find_tokens(all_commands[i], default_delimiters, commands[i], i) == -1)
+            {
+                free(input_backup);
+                return -1;
+            }
+        }
+    }
+    else
+    {
+        // if no speical character is selected, only 1 command exists
+        ret_value = find_tokens(input_backup, default_delimiters, &command_1, -1);
+    }
+
+    free(input_backup);
+    return ret_value;
+}
+
+// ;, |, && and || need a command on both sides and <, >, >> a file after them,
+// so ls | or cat < is a syntax error when it's parsed, like in bash, not only once it runs
+// returns -1 if a command or file is missing, returns 1 otherwise
+int validate_commands()
+{
+    char message[64];
+
+    if (selected_special_char >= 2 && selected_special_char <= 4 && command_2[0] == NULL)
+    {
+        printf("Provide the file name you want to redirect to, after '%s'\n", special_chars[selected_special_char]);
+        return -1;
+    }
+    if (selected_special_char < 6)
+    {
+        return 1;
+    }
+    snprintf(message, sizeof(message), "Syntax Error, Unexpected token near '%s'", special_chars[selected_special_char]);
+    return check_all_commands_exist(message);
+}
+
+// PART 3: Perform Commands - Functions
+
+// returns the number of parameter in a command
+// returns length
+int find_command_length(char *command[5])
+{
+    int len = 0;
+
+    while (command[len] != NULL)
+    {
+        len++;
+    }
+    return len;
+}
+
+// this function will find selected option and verify that it exists
+void find_custom_command(struct minibash *interpreter, char *token)
+{
+    // builtins are in name table along with functions, aliases and commands from PATH
+    struct name_entry *entry = find_name(interpreter, token, strlen(token), false);
+    selected_custom_command = entry ? entry->builtin : -1;
+}
+
+// ~ is a special character, so for cd ~/path and pushd ~/path tokens are found again from input
+// returns command to use
+char **find_directory_command(char *command[], char *input, char *default_delimiters)
+{
+    if (selected_special_char == 5)
+    {
+        free_command(command_1);
+        find_tokens(input, default_delimiters, &command_1, -1); // save input in command_1
+        command = command_1;
+    }
+    return command;
+}
+
+// since cd is a bash utility and not a command it won't run using exec.
+// cd alone and ~ go to home directory, cd - to previous directory
+// directory is opened once and thread changes to it by its fd, previous directory is kept open for cd -
+// returns 0 on success, -1 on error
+int cd_command(struct minibash *interpreter, char *command[], char *input, char *default_delimiters)
+{
+    command = find_directory_command(command, input, default_delimiters);
+
+    // if command length is not 2 then not allowed to run this program
+    if (find_command_length(command) > 2)
+    {
+        printf("cd: too many arguments\n");
+        return -1;
+    }
+
+    if (command[1] == NULL)
+    {
+        return change_directory_to(interpreter, get_home(interpreter), "cd");
+    }
+    if (strcmp(command[1], "-") != 0)
+    {
+        return change_directory_to(interpreter, command[1], "cd");
+    }
+
+    // cd - goes back without looking the directory up again
+    if (interpreter->previous_directory.fd == -1)
+    {
+        printf("cd: OLDPWD not set\n");
+        return -1;
+    }
+    if (change_directory(interpreter, interpreter->previous_directory) == -1)
+    {
+        printf("cd: %s\n", strerror(errno));
+        return -1;
+    }
+    print_directory(interpreter, get_cwd_path(interpreter));
+    printf("\n");
+    return 0;
+}
+
+// for pushd
+// pushd DIR puts current directory on directory stack and goes to DIR, pushd alone swaps current directory
+// with top of the stack, stack is printed after that
+// returns 0 on success, -1 on error
+int pushd_command(struct minibash *interpreter, char *command[], char *input, char *default_delimiters)
+{
+    command = find_directory_command(command, input, default_delimiters);
+    if (find_command_length(command) > 2)
+    {
+        printf("pushd: too many arguments\n");
+        return -1;
+    }
+    if (command[1] == NULL && interpreter->directory_stack_num == 0)
+    {
+        printf("pushd: no other directory\n");
+        return -1;
+    }
+
+    struct directory current = copy_cwd(interpreter);
+    if (current.fd == -1)
+    {
+        printf("pushd: %s\n", strerror(errno));
+        free(current.path);
+        return -1;
+    }
+
+    if (command[1] == NULL)
+    {
+        struct directory top = interpreter->directory_stack[interpreter->directory_stack_num - 1];
+        if (change_directory(interpreter, top) == -1)
+        {
+            printf("pushd: %s: %s\n", top.path ? top.path : "", strerror(errno));
+            close_directory(&current);
+            return -1;
+        }
+        interpreter->directory_stack[interpreter->directory_stack_num - 1] = current;
+    }
+    else
+    {
+        if (change_directory_to(interpreter, command[1], "pushd") == -1)
+        {
+            close_directory(&current);
+            return -1;
+        }
+        if (interpreter->directory_stack_num == interpreter->directory_stack_capacity)
+        {
+            int capacity = interpreter->directory_stack_capacity ? interpreter->directory_stack_capacity * 2 : 8;
+            interpreter->directory_stack = realloc(interpreter->directory_stack, sizeof(struct directory) * capacity);
+            interpreter->directory_stack_capacity = capacity;
+        }
+        interpreter->directory_stack[interpreter->directory_stack_num++] = current;
+    }
+
+    print_directory_stack(interpreter);
+    return 0;
+}
+
+// for popd
+// takes top of directory stack off and goes to it, stack is printed after that
+// returns 0 on success, -1 on error
+int popd_command(struct minibash *interpreter, char *command[])
+{
+    if (command[1] != NULL)
+    {
+        printf("popd: too many arguments\n");
+        return -1;
+    }
+    if (interpreter->directory_stack_num == 0)
+    {
+        printf("popd: directory stack empty\n");
+        return -1;
+    }
+
+    struct directory top = interpreter->directory_stack[interpreter->directory_stack_num - 1];
+    if (change_directory(interpreter, top) == -1)
+    {
+        printf("popd: %s: %s\n", top.path ? top.path : "", strerror(errno));
+        return -1;
+    }
+    interpreter->directory_stack_num--;
+
+    print_directory_stack(interpreter);
+    return 0;
+}
+
+// parses sizes like 4096, 64K, 16M, 1G and on, off
+// returns -1 if value is not valid
+long long parse_option_value(char *value)
+{
+    if (strcmp(value, "on") == 0)
+        return 1;
+    if (strcmp(value, "off") == 0)
+        return 0;
+
+    char *end;
+    errno = 0;
+    long long size = strtoll(value, &end, 10);
+    if (errno != 0 || end == value || size < 0)
+        return -1;
+
+    switch (toupper((unsigned char)*end))
+    {
+    case 'G':
+        size *= 1024;
+        /* fall through */
+    case 'M':
+        size *= 1024;
+        /* fall through */
+    case 'K':
+        size *= 1024;
+        end++;
+        break;
+    default:
+        break;
+    }
+
+    return *end == '\0' ? size : -1;
+}
+
+// for set
+// set prints all options, set name=value changes an option
+// returns 0 on success, -1 on error
+int set_command(struct minibash *interpreter, char *command[])
+{
+    int options_num = sizeof(shell_options) / sizeof(shell_options[0]);
+    long long *values[] = {&interpreter->prealloc_size, &interpreter->pipestats, &interpreter->pipe_size};
+
+    if (command[1] == NULL)
+    {
+        for (int i = 0; i < options_num; i++)
+        {
+            printf("%s=%lld\n", shell_options[i], *values[i]);
+        }
+        return 0;
+    }
+
+    for (int i = 1; command[i] != NULL; i++)
+    {
+        char *equals = strchr(command[i], '=');
+        if (!equals)
+        {
+            printf("set: usage: set name=value\n");
+            return -1;
+        }
+
+        int j = 0;
+        while (j < options_num && strncmp(shell_options[j], command[i], equals - command[i]) != 0)
+        {
+            j++;
+        }
+        if (j == options_num || shell_options[j][equals - command[i]] != '\0')
+        {
+            printf("set: %.*s: no such option\n", (int)(equals - command[i]), command[i]);
+            return -1;
+        }
+
+        long long value = parse_option_value(equals + 1);
+        if (value == -1)
+        {
+            printf("set: %s: invalid value\n", equals + 1);
+            return -1;
+        }
+        *values[j] = value;
+    }
+    return 0;
+}
+
+// for timeout, retry and limit
+// true if timeout or limit applies to commands being started
+bool has_command_limits()
+{
+    for (int i = 0; i < COMMAND_LIMITS; i++)
+    {
+        if (command_limits[i].is_set)
+        {
+            return true;
+        }
+    }
+    return command_deadline.tv_sec != 0;
+}
+
+// applies limits of limit command, called in child between fork and exec
+void apply_command_limits()
+{
+    for (int i = 0; i < COMMAND_LIMITS; i++)
+    {
+        if (command_limits[i].is_set)
+        {
+            struct rlimit limit = {command_limits[i].value, command_limits[i].value};
+            setrlimit(command_limits[i].resource, &limit);
+        }
+    }
+}
+
+// true if time a is before time b
+bool is_time_before(struct timespec a, struct timespec b)
+{
+    return a.tv_sec < b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec);
+}
+
+// kills child when command_deadline passes, asking it to stop first and making it TIMEOUT_GRACE_MS later
+// for kernels without pidfd_open or timerfd, child is looked at with waitpid every TIMEOUT_POLL_MS
+// returns wait status of child, TIMEOUT_STATUS if it was killed because of timeout, -1 on error
+int wait_for_child_polling(int child_pid)
+{
+    struct timespec kill_at = command_deadline, now;
+    bool is_timed_out = false;
+    int status;
+
+    while (true)
+    {
+        int pid = waitpid(child_pid, &status, WNOHANG);
+        if (pid == child_pid)
+        {
+            return is_timed_out ? TIMEOUT_STATUS : status;
+        }
+        if (pid == -1 && errno != EINTR)
+        {
+            printf("minibash: waitpid: %s\n", strerror(errno));
+            return -1;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (!is_time_before(now, kill_at))
+        {
+            kill(child_pid, is_timed_out ? SIGKILL : SIGTERM);
+            kill_at = now;
+            kill_at.tv_sec += TIMEOUT_GRACE_MS / 1000;
+            kill_at.tv_nsec += TIMEOUT_GRACE_MS % 1000 * 1000000;
+            if (kill_at.tv_nsec >= 1000000000)
+            {
+                kill_at.tv_sec++;
+                kill_at.tv_nsec -= 1000000000;
+            }
+            is_timed_out = true;
+        }
+        poll(NULL, 0, TIMEOUT_POLL_MS);
+    }
+}
+
+// waits for child like waitpid, killing it when command_deadline passes
+// a pidfd and a timerfd are polled together, so no process or signal is needed for the timeout,
+// without them it's wait_for_child_polling
+// returns wait status of child, TIMEOUT_STATUS if it was killed because of timeout, -1 on error
+int wait_for_child(int child_pid)
+{
+    int status;
+    int pid_fd = command_deadline.tv_sec ? syscall(SYS_pidfd_open, child_pid, 0) : -1;
+    int timer_fd = pid_fd != -1 ? timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC) : -1;
+    bool is_timed_out = false;
+
+    if (command_deadline.tv_sec && timer_fd == -1)
+    {
+        if (pid_fd != -1)
+        {
+            close(pid_fd);
+        }
+        return wait_for_child_polling(child_pid);
+    }
+
+    if (timer_fd != -1)
+    {
+        struct itimerspec timer = {{0, 0}, command_deadline};
+        timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &timer, NULL);
+
+        struct pollfd poll_fds[2] = {{.fd = pid_fd, .events = POLLIN}, {.fd = timer_fd, .events = POLLIN}};
+        while (true)
+        {
+            if (poll(poll_fds, 2, -1) == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                // command isn't left running without its timeout
+                printf("minibash: poll: %s\n", strerror(errno));
+                kill(child_pid, SIGKILL);
+                close(timer_fd);
+                close(pid_fd);
+                while (waitpid(child_pid, &status, 0) == -1 && errno == EINTR)
+                    ;
+                return -1;
+            }
+            if (poll_fds[0].revents)
+            {
+                break;
+            }
+
+            // first expiry asks command to stop, second one after grace time makes it
+            uint64_t expirations;
+            read(timer_fd, &expirations, sizeof(expirations));
+            kill(child_pid, is_timed_out ? SIGKILL : SIGTERM);
+            if (!is_timed_out)
+            {
+                struct itimerspec grace = {{0, 0}, {TIMEOUT_GRACE_MS / 1000, TIMEOUT_GRACE_MS % 1000 * 1000000}};
+                timerfd_settime(timer_fd, 0, &grace, NULL);
+            }
+            is_timed_out = true;
+        }
+        close(timer_fd);
+    }
+    if (pid_fd != -1)
+    {
+        close(pid_fd);
+    }
+
+    while (waitpid(child_pid, &status, 0) == -1 && errno == EINTR)
+        ;
+    return is_timed_out ? TIMEOUT_STATUS : status;
+}
+
+// for timeout
+// timeout SECS COMMAND runs command, killing it if it still runs after SECS seconds
+// applies to every command a function runs, all of them together get SECS seconds
+// returns wait status of command, TIMEOUT_STATUS if it timed out
+int timeout_command(struct minibash *interpreter, char *command[], char *input)
+{
+    char *end;
+    double seconds = command[1] ? strtod(command[1], &end) : 0;
+    if (command[1] == NULL || command[2] == NULL || *end != '\0' || end == command[1] || seconds <= 0)
+    {
+        printf("timeout: usage: timeout SECS COMMAND\n");
+        return 2 << 8;
+    }
+
+    struct timespec saved = command_deadline, deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += (time_t)seconds;
+    deadline.tv_nsec += (long)((seconds - (time_t)seconds) * 1e9);
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    // a timeout inside another one can only make deadline earlier
+    if (saved.tv_sec == 0 || is_time_before(deadline, saved))
+    {
+        command_deadline = deadline;
+    }
+    int status = fork_and_run(interpreter, command + 2, input);
+    command_deadline = saved;
+    return status;
+}
+
+// for retry
+// retry N COMMAND runs command until it succeeds, at most N times
+// returns wait status of last run of command
+int retry_command(struct minibash *interpreter, char *command[], char *input)
+{
+    char *end;
+    long times = command[1] ? strtol(command[1], &end, 10) : 0;
+    if (command[1] == NULL || command[2] == NULL || *end != '\0' || times <= 0)
+    {
+        printf("retry: usage: retry N COMMAND\n");
+        return 2 << 8;
+    }
+
+    int status = 0;
+    for (long i = 0; i < times; i++)
+    {
+        // command is expanded once, runs change nothing of it but a copy is given in case they do
+        char **copy = copy_command(command + 2);
+        status = fork_and_run(interpreter, copy, input);
+        free_command(copy);
+        // a timeout around retry has passed, every other run would time out too
+        if (status == 0 || (status == TIMEOUT_STATUS && command_deadline.tv_sec != 0))
+        {
+            break;
+        }
+    }
+    return status;
+}
+
+// for limit
+// limit mem=SIZE,cpu=SECS,nofile=N COMMAND runs command with those resource limits, any of them can be left out
+// returns wait status of command
+int limit_command(struct minibash *interpreter, char *command[], char *input)
+{
+    if (command[1] == NULL || command[2] == NULL)
+    {
+        printf("limit: usage: limit mem=SIZE,cpu=SECS,nofile=N COMMAND\n");
+        return 2 << 8;
+    }
+
+    struct command_limit saved[COMMAND_LIMITS];
+    memcpy(saved, command_limits, sizeof(command_limits));
+
+    char *limits = strdup(command[1]);
+    char *position;
+    int status = 0;
+    for (char *limit = strtok_r(limits, ",", &position); limit; limit = strtok_r(NULL, ",", &position))
+    {
+        char *equals = strchr(limit, '=');
+        int i = 0;
+        while (equals && i < COMMAND_LIMITS &&
+               (strncmp(command_limits[i].name, limit, equals - limit) != 0 || command_limits[i].name[equals - limit] != '\0'))
+        {
+            i++;
+        }
+        long long value = equals ? parse_option_value(equals + 1) : -1;
+        if (!equals || i == COMMAND_LIMITS || value == -1)
+        {
+            printf("limit: %s: invalid limit\n", limit);
+            status = 2 << 8;
+            break;
+        }
+        // a limit inside another one can only make it lower
+        if (!command_limits[i].is_set || (rlim_t)value < command_limits[i].value)
+        {
+            command_limits[i].is_set = true;
+            command_limits[i].value = value;
+        }
+    }
+    free(limits);
+
+    if (status == 0)
+    {
+        status = fork_and_run(interpreter, command + 2, input);
+    }
+    memcpy(command_limits, saved, sizeof(command_limits));
+    return status;
+}
+
+// performs command according to selected_command
+// returns exit status of command
+// 0 for success, -1 for error
+int perform_custom_command(struct minibash *interpreter, char *command[], char *input)
+{
+    int size;
+    // make commands and store below to run
+    char *minibash_command[] = {"minibash", "minibash", NULL};
+
+    switch (selected_custom_command)
+    {
+    case 0:
+        // for cd
+        return cd_command(interpreter, command, input, default_delimiters);
+        break;
+    case 1:
+        // for dter command, kill current bash
+        if (!is_program)
+        {
+            printf("dter: only for the minibash program\n");
+            return -1;
+        }
+        if (kill(getpid(), SIGKILL) == -1)
+            return -1;
+        break;
+
+    case 2:
+        // for dtex command, kill every minibash of user found in registry, then this one
+        if (!is_program)
+        {
+            printf("dtex: only for the minibash program\n");
+            return -1;
+        }
+        signal_instances(SIGKILL, 0);
+        if (kill(getpid(), SIGKILL) == -1)
+            return -1;
+        break;
+
+    case 3:
+        return fork_and_run(interpreter, minibash_command, NULL);
+        break;
+
+    case 4:
+        // for exit command, whatever is running commands stops, the minibash program then exits
+        interpreter->is_exit_requested = true;
+        break;
+
+    case 5:
+        // for fore command, bring background process to foreground
+        // pop the last process
+        size = find_size(interpreter);
+        if (size >= 1)
+        {
+            int pid = interpreter->background_processes_pids[size - 1];
+            get_index_and_shift(interpreter, pid);                 // get index and shift array
+            interpreter->background_processes_pids[size - 1] = -1; // remove from process id
+            printf("Process with pid:%d moved to foreground\n", pid);
+            kill(pid, SIGCONT); // send sigcont signal to child who is in background
+        }
+        else
+        {
+            printf("fg: current: no such job\n");
+        }
+        break;
+
+    case 6:
+        // for clear command
+        printf("\e[1;1H\e[2J"); // clear screen ascii
+        break;
+
+    case 7:
+        // for set command
+        return set_command(interpreter, command);
+        break;
+
+    case 8:
+        // for export command
+        return export_command(interpreter, command);
+        break;
+
+    case 9:
+        // for unset command
+        return unset_command(interpreter, command);
+        break;
+
+    case 10:
+        // for alias command
+        return alias_command(interpreter, command);
+        break;
+
+    case 11:
+        // for unalias command
+        return unalias_command(interpreter, command);
+        break;
+
+    case 12:
+        // for hash command
+        return hash_command(interpreter, command);
+        break;
+
+    case 13:
+        // for history command
+        return history_command(interpreter, command);
+        break;
+
+    case 14:
+        // for instances command
+        return instances_command(command);
+        break;
+
+    case 15:
+        // for watch command
+        return watch_command(interpreter, command);
+        break;
+
+    case 16:
+        // for timeout command
+        return timeout_command(interpreter, command, input);
+        break;
+
+    case 17:
+        // for retry command
+        return retry_command(interpreter, command, input);
+        break;
+
+    case 18:
+        // for limit command
+        return limit_command(interpreter, command, input);
+        break;
+
+    case 19:
+        // for pushd command
+        return pushd_command(interpreter, command, input, default_delimiters);
+        break;
+
+    case 20:
+        // for popd command
+        return popd_command(interpreter, command);
+        break;
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+// opens file of a FD_ACTION_OPEN redirection
+// returns fd on success, prints error and returns -1 on failure
+int open_redirection(struct minibash *interpreter, struct fd_action *action, int extra_flags)
+{
+    // relative to directory of interpreter, whichever directory the thread or process opening it is in
+    int at = interpreter->cwd_fd == -1 ? AT_FDCWD : interpreter->cwd_fd;
+    int fd = openat(at, action->path, action->flags | extra_flags, 0644);
+    if (fd == -1)
+    {
+        fprintf(stderr, "minibash: %s: %s\n", action->path, strerror(errno));
+        return -1;
+    }
+
+    // reserve space for big outputs up front so the file is less fragmented,
+    // size of the file doesn't change, failure only means no preallocation
+    if (interpreter->prealloc_size > 0 && (action->flags & O_TRUNC))
+    {
+        fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, interpreter->prealloc_size);
+    }
+    return fd;
+}
+
+// makes fd from which data of a FD_ACTION_DATA redirection can be read, nothing is written to disk
+// small data is written to a pipe, which holds it without anyone reading, bigger data to a memfd
+// returns fd on success, prints error and returns -1 on failure
+int open_data(struct minibash *interpreter, struct fd_action *action, int extra_flags)
+{
+    size_t length = strlen(action->path);
+    int fd[2];
+
+    if (length <= HERE_PIPE_MAX)
+    {
+        if (make_pipe(interpreter, fd, extra_flags) == -1)
+        {
+            fprintf(stderr, "minibash: here document: %s\n", strerror(errno));
+            return -1;
+        }
+        write_all(fd[1], action->path, length);
+        close(fd[1]);
+        return fd[0];
+    }
+
+    fd[0] = memfd_create("here-document", extra_flags & O_CLOEXEC ? MFD_CLOEXEC : 0);
+    if (fd[0] == -1 || write_all(fd[0], action->path, length) == -1 || lseek(fd[0], 0, SEEK_SET) == -1)
+    {
+        fprintf(stderr, "minibash: here document: %s\n", strerror(errno));
+        if (fd[0] != -1)
+        {
+            close(fd[0]);
+        }
+        return -1;
+    }
+    return fd[0];
+}
+
+// applies redirections in child process, after fork and before exec
+// files are opened here so the parent's file descriptors are never changed,
+// which also means nothing buffered in the parent can end up in a redirected file
+// exits child if a redirection can't be done, with _exit so a script minibash is reading isn't rewound,
+// error is written to unbuffered stderr before that
+void apply_redirections(struct minibash *interpreter)
+{
+    for (int i = 0; i < redirections_num; i++)
+    {
+        struct fd_action *action = &redirections[i];
+
+        if (action->kind == FD_ACTION_OPEN || action->kind == FD_ACTION_DATA)
+        {
+            int fd = action->kind == FD_ACTION_OPEN ? open_redirection(interpreter, action, 0)
+                                                    : open_data(interpreter, action, 0);
+            if (fd == -1)
+            {
+                _exit(1);
+            }
+            if (fd != action->fd)
+            {
+                dup2(fd, action->fd);
+                close(fd);
+            }
+        }
+        else if (dup2(action->source_fd, action->fd) == -1)
+        {
+            fprintf(stderr, "minibash: %d: %s\n", action->source_fd, strerror(errno));
+            _exit(1);
+        }
+    }
+}
+
+// puts back file descriptors apply_redirections_in_place replaced, first saved_num of them
+void restore_redirections(int saved[], int saved_num)
+{
+    fflush(stdout);
+    for (int i = saved_num - 1; i >= 0; i--)
+    {
+        // -1 is a file descriptor that wasn't open before
+        if (saved[i] == -1)
+        {
+            close(redirections[i].fd);
+            continue;
+        }
+        dup2(saved[i], redirections[i].fd);
+        close(saved[i]);
+    }
+}
+
+// applies redirections to minibash itself, for functions and builtins, which run without a fork
+// file descriptors they replace are kept in saved, restore_redirections puts them back
+// returns -1 if a redirection can't be done, which is printed, nothing is left redirected then
+int apply_redirections_in_place(struct minibash *interpreter, int saved[])
+{
+    fflush(stdout); // what's printed before goes where it was meant to
+    for (int i = 0; i < redirections_num; i++)
+    {
+        struct fd_action *action = &redirections[i];
+        int fd = action->kind == FD_ACTION_OPEN   ? open_redirection(interpreter, action, O_CLOEXEC)
+                 : action->kind == FD_ACTION_DATA ? open_data(interpreter, action, O_CLOEXEC)
+                                                  : action->source_fd;
+        if (fd == -1)
+        {
+            restore_redirections(saved, i);
+            return -1;
+        }
+
+        saved[i] = fcntl(action->fd, F_DUPFD_CLOEXEC, 10);
+        if (dup2(fd, action->fd) == -1)
+        {
+            fprintf(stderr, "minibash: %d: %s\n", fd, strerror(errno));
+            if (saved[i] != -1)
+            {
+                close(saved[i]);
+            }
+            restore_redirections(saved, i);
+            return -1;
+        }
+        if (action->kind != FD_ACTION_DUP && fd != action->fd)
+        {
+            close(fd);
+        }
+    }
+    return 0;
+}
+
+// for tee inside minibash
+// tee without options is run by minibash itself, so a stream can be fanned out to
+// >(cmd) substitutions and files without starting another program
+// returns true if command should be run with run_fanout
+bool is_fanout_command(char *command[])
+{
+    if (strcmp(command[0], "tee") != 0)
+    {
+        return false;
+    }
+
+    for (int i = 1; command[i] != NULL; i++)
+    {
+        if (command[i][0] == '-')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// writes all bytes of buffer to fd
+// returns -1 on error
+int write_all(int fd, char *buffer, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t written = write(fd, buffer, length);
+        if (written == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        buffer += written;
+        length -= written;
+    }
+    return 1;
+}
+
+// returns true if fd is a pipe
+bool is_pipe(int fd)
+{
+    struct stat info;
+    return fstat(fd, &info) == 0 && S_ISFIFO(info.st_mode);
+}
+
+// copies stdin to stdout and to every file in command, like tee
+// when all of them are pipes, data is duplicated with tee(2) and moved with splice(2)
+// so it never passes through minibash, otherwise it's read once and written to each output
+// returns exit status for the child running it
+int run_fanout(char *command[])
+{
+    int outputs[MAX_ARGS + 1];
+    int outputs_num = 0;
+    bool all_pipes = is_pipe(0);
+
+    outputs[outputs_num++] = 1;
+    for (int i = 1; command[i] != NULL && outputs_num <= MAX_ARGS; i++)
+    {
+        int fd = open(command[i], O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd == -1)
+        {
+            fprintf(stderr, "tee: %s: %s\n", command[i], strerror(errno));
+            return 1;
+        }
+        outputs[outputs_num++] = fd;
+    }
+
+    for (int i = 0; i < outputs_num; i++)
+    {
+        all_pipes = all_pipes && is_pipe(outputs[i]);
+    }
+
+    char *buffer = malloc(FANOUT_CHUNK);
+
+    while (true)
+    {
+        ssize_t bytes = 0;
+        int done = 0;       // outputs which already have this chunk
+        ssize_t partial = 0; // bytes of this chunk output done already has
+
+        if (all_pipes && outputs_num == 1)
+        {
+            // nothing to duplicate, just move data
+            bytes = splice(0, NULL, outputs[0], NULL, FANOUT_CHUNK, SPLICE_F_MOVE);
+            if (bytes > 0)
+                continue;
+            if (bytes == 0)
+                break;
+            all_pipes = false; // i.e. splice not supported, copy instead
+        }
+        else if (all_pipes)
+        {
+            // duplicate chunk to every output except the last one without consuming it
+            bytes = tee(0, outputs[0], FANOUT_CHUNK, 0);
+            if (bytes == 0)
+                break;
+
+            if (bytes > 0)
+            {
+                done = 1;
+                while (done < outputs_num - 1)
+                {
+                    partial = tee(0, outputs[done], bytes, 0);
+                    if (partial < bytes)
+                    {
+                        // output was full, rest of this chunk is copied below
+                        partial = partial > 0 ? partial : 0;
+                        break;
+                    }
+                    partial = 0;
+                    done++;
+                }
+            }
+
+            if (bytes > 0 && done == outputs_num - 1)
+            {
+                // move chunk into last output, which consumes it from stdin
+                while (bytes > 0)
+                {
+                    ssize_t moved = splice(0, NULL, outputs[done], NULL, bytes, SPLICE_F_MOVE);
+                    if (moved <= 0)
+                        return 1;
+                    bytes -= moved;
+                }
+                continue;
+            }
+
+            if (bytes == -1)
+            {
+                all_pipes = false; // i.e. tee not supported, copy instead
+                bytes = 0;
+            }
+        }
+
+        // copy chunk by reading it once
+        // if tee stopped half way, the chunk it saw is read and written to outputs which don't have it
+        ssize_t chunk = read(0, buffer, bytes > 0 ? bytes : FANOUT_CHUNK);
+        if (chunk == 0)
+            break;
+        if (chunk == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            return 1;
+        }
+
+        for (int i = done; i < outputs_num; i++)
+        {
+            if (write_all(outputs[i], buffer + partial, chunk - partial) == -1)
+            {
+                return 1;
+            }
+            partial = 0;
+        }
+    }
+
+    free(buffer);
+    return 0;
+}
+
+// starts commands of process substitutions in children, each connected to minibash with a pipe
+// then replaces markers in all commands with /dev/fd/N, where N is minibash's end of the pipe
+// returns -1 on error
+int start_substitutions(struct minibash *interpreter)
+{
+    for (int i = 0; i < substitutions_num; i++)
+    {
+        struct process_substitution *substitution = &substitutions[i];
+        int fd[2];
+
+        if (make_pipe(interpreter, fd, O_CLOEXEC) == -1)
+        {
+            printf("Pipe Failed\n");
+            return -1;
+        }
+
+        fflush(stdout); // so child doesn't print what's still buffered in minibash
+        int child_pid = fork();
+
+        if (child_pid == 0)
+        {
+            // child process, runs the command as a separate input
+            dup2(fd[substitution->is_output ? 0 : 1], substitution->is_output ? 0 : 1);
+            close(fd[0]);
+            close(fd[1]);
+            // last command of a pipe writes to stdout of minibash, which is the pipe for <(cmd)
+            // if it wasn't backed up yet, the backup taken later is the pipe anyway
+            if (stdout_fd_backup != -1)
+            {
+                dup3(1, stdout_fd_backup, O_CLOEXEC);
+            }
+
+            // ends of earlier substitutions aren't close on exec anymore, so close them here,
+            // otherwise a >(cmd) would never see end of file
+            for (int j = 0; j < i; j++)
+            {
+                close(substitutions[j].fd);
+            }
+
+            // _exit, so stdio doesn't rewind the script minibash is reading
+            char *command = strdup(substitution->command);
+            reset();
+            minibash(interpreter, command);
+            fflush(stdout);
+            _exit(0);
+        }
+        else if (child_pid == -1)
+        {
+            printf("Fork Failed\n");
+            close(fd[0]);
+            close(fd[1]);
+            return -1;
+        }
+
+        // keep minibash's end, commands of this input inherit it
+        substitution->pid = child_pid;
+        substitution->fd = fd[substitution->is_output ? 1 : 0];
+        close(fd[substitution->is_output ? 0 : 1]);
+        fcntl(substitution->fd, F_SETFD, 0);
+    }
+
+    // swap markers with paths
+    char **commands[] = {command_1, command_2, command_3, command_4};
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; commands[i][j] != NULL; j++)
+        {
+            char *marker = strchr(commands[i][j], SUBSTITUTION_MARKER);
+            if (!marker)
+            {
+                continue;
+            }
+
+            struct string_buffer word;
+            string_buffer_init(&word);
+            for (char *c = commands[i][j]; *c != '\0'; c++)
+            {
+                if (*c == SUBSTITUTION_MARKER && c[1] != '\0')
+                {
+                    char path[32];
+                    snprintf(path, sizeof(path), "/dev/fd/%d", substitutions[c[1] - '0'].fd);
+                    string_buffer_append(&word, path);
+                    c++;
+                }
+                else
+                {
+                    string_buffer_append_char(&word, *c);
+                }
+            }
+
+            free(commands[i][j]);
+            commands[i][j] = word.data;
+        }
+    }
+    return 1;
+}
+
+// closes minibash's ends of process substitutions and waits for their commands
+// closing first lets >(cmd) see end of file and stops <(cmd) that nobody reads
+void finish_substitutions()
+{
+    for (int i = 0; i < substitutions_num; i++)
+    {
+        if (substitutions[i].fd != -1)
+        {
+            close(substitutions[i].fd);
+            substitutions[i].fd = -1;
+        }
+    }
+
+    for (int i = 0; i < substitutions_num; i++)
+    {
+        if (substitutions[i].pid != -1)
+        {
+            waitpid(substitutions[i].pid, NULL, 0);
+            substitutions[i].pid = -1;
+        }
+    }
+}
+
+// SPAWN HELPER
+// sends fds over socket along with message
+// returns -1 on error
+int send_with_fds(int socket_fd, void *message, size_t length, int *fds, int fds_num)
+{
+    struct iovec iov = {.iov_base = message, .iov_len = length};
+    char control[CMSG_SPACE(sizeof(int) * SPAWN_FDS)];
+    struct msghdr header = {.msg_iov = &iov, .msg_iovlen = 1};
+
+    if (fds_num > 0)
+    {
+        memset(control, 0, sizeof(control));
+        header.msg_control = control;
+        header.msg_controllen = CMSG_SPACE(sizeof(int) * fds_num);
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds_num);
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fds_num);
+    }
+
+    // MSG_NOSIGNAL, so a dead helper is an error and not a SIGPIPE
+    return sendmsg(socket_fd, &header, MSG_NOSIGNAL) == -1 ? -1 : 1;
+}
+
+// forks command of request in message, puts fds on 0, 1, 2, changes to directory fds[3],
+// applies environment changes and execs
+// child gets mask as its signal mask
+// returns pid of command, -1 on error
+int spawn_command(char *message, int *fds, sigset_t *mask)
+{
+    struct spawn_request request;
+    memcpy(&request, message, sizeof(request));
+
+    // path, arguments and environment changes point into message
+    char **strings = malloc(sizeof(char *) * (request.argc + request.envc + 1));
+    char *path = message + sizeof(request);
+    char *p = path + strlen(path) + 1;
+    for (int i = 0; i < request.argc + request.envc; i++)
+    {
+        strings[i] = p;
+        p += strlen(p) + 1;
+    }
+
+    int pid = fork();
+    if (pid == 0)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            dup2(fds[i], i);
+        }
+        if (fds[3] != -1)
+        {
+            fchdir(fds[3]);
+        }
+        for (int i = request.argc; i < request.argc + request.envc; i++)
+        {
+            if (strchr(strings[i], '='))
+                putenv(strings[i]);
+            else
+                unsetenv(strings[i]);
+        }
+        strings[request.argc] = NULL;
+        signal(SIGINT, SIG_DFL);
+        sigprocmask(SIG_SETMASK, mask, NULL);
+
+        // path is where minibash found command in PATH, if it did
+        if (strchr(path, '/'))
+        {
+            execv(path, strings);
+        }
+        execvp(strings[0], strings);
+        dprintf(1, "minibash: %s: command not found\n", strings[0]);
+        _exit(COMMAND_NOT_FOUND);
+    }
+    free(strings);
+    return pid;
+}
+
+// sends exit status of every command that is done to channel it came from
+void reap_spawned_commands(struct spawned_command *commands, int *commands_num)
+{
+    int pid, status;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+    {
+        for (int i = 0; i < *commands_num; i++)
+        {
+            if (commands[i].pid != pid)
+            {
+                continue;
+            }
+            struct spawn_reply reply = {.id = commands[i].id, .pid = pid, .status = status, .exited = true};
+            if (commands[i].channel_fd != -1)
+            {
+                send(commands[i].channel_fd, &reply, sizeof(reply), MSG_NOSIGNAL);
+            }
+            commands[i] = commands[--*commands_num];
+            break;
+        }
+    }
+}
+
+// loop of spawn helper process, never returns
+// waits on socket_fd for channels and on every channel for requests, for every request: forks, puts
+// received fds on 0, 1, 2, changes directory, applies environment changes and execs, then tells its channel
+// the pid and, once signalfd says it's done, exit status of the command
+// commands of different channels run at the same time, helper never waits for one of them
+void run_spawn_helper(int socket_fd)
+{
+    char *message = malloc(SPAWN_MESSAGE_MAX);
+    char control[CMSG_SPACE(sizeof(int) * SPAWN_FDS)];
+    struct spawned_command *commands = NULL;
+    int commands_num = 0, commands_capacity = 0;
+    sigset_t mask, old_mask;
+
+    // ctrl+c is for minibash, helper goes away when minibash closes the socket
+    signal(SIGINT, SIG_IGN);
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &mask, &old_mask);
+
+    // 0 is signalfd, 1 is socket_fd, channels come after
+    int polled_num = 2, polled_capacity = 8;
+    struct pollfd *polled = malloc(sizeof(struct pollfd) * polled_capacity);
+    polled[0] = (struct pollfd){.fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC), .events = POLLIN};
+    polled[1] = (struct pollfd){.fd = socket_fd, .events = POLLIN};
+
+    while (true)
+    {
+        if (poll(polled, polled_num, -1) == -1)
+        {
+            continue;
+        }
+
+        if (polled[0].revents)
+        {
+            struct signalfd_siginfo info;
+            while (read(polled[0].fd, &info, sizeof(info)) > 0)
+            {
+            }
+            reap_spawned_commands(commands, &commands_num);
+        }
+
+        for (int i = 1; i < polled_num; i++)
+        {
+            if (polled[i].revents == 0)
+            {
+                continue;
+            }
+
+            struct iovec iov = {.iov_base = message, .iov_len = SPAWN_MESSAGE_MAX};
+            struct msghdr header = {.msg_iov = &iov, .msg_iovlen = 1, .msg_control = control, .msg_controllen = sizeof(control)};
+            ssize_t length = recvmsg(polled[i].fd, &header, MSG_CMSG_CLOEXEC);
+
+            if (length <= 0 && i == 1)
+            {
+                _exit(0);
+            }
+            // interpreter of channel is gone, its commands are still reaped
+            if (length <= 0)
+            {
+                for (int j = 0; j < commands_num; j++)
+                {
+                    if (commands[j].channel_fd == polled[i].fd)
+                    {
+                        commands[j].channel_fd = -1;
+                    }
+                }
+                close(polled[i].fd);
+                polled[i--] = polled[--polled_num];
+                continue;
+            }
+
+            int fds[SPAWN_FDS] = {-1, -1, -1, -1};
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header);
+            if (cmsg && cmsg->cmsg_type == SCM_RIGHTS)
+            {
+                memcpy(fds, CMSG_DATA(cmsg), cmsg->cmsg_len - CMSG_LEN(0));
+            }
+
+            struct spawn_request request;
+            memcpy(&request, message, sizeof(request));
+            if (request.argc == SPAWN_NEW_CHANNEL)
+            {
+                if (polled_num == polled_capacity)
+                {
+                    polled_capacity *= 2;
+                    polled = realloc(polled, sizeof(struct pollfd) * polled_capacity);
+                }
+                polled[polled_num++] = (struct pollfd){.fd = fds[0], .events = POLLIN};
+                continue;
+            }
+
+            struct spawn_reply reply = {.id = request.id, .pid = spawn_command(message, fds, &old_mask), .status = 0, .exited = false};
+            for (int j = 0; j < SPAWN_FDS; j++)
+            {
+                if (fds[j] != -1)
+                    close(fds[j]);
+            }
+
+            if (reply.pid == -1)
+            {
+                reply.exited = true;
+                reply.status = 255 << 8;
+            }
+            else
+            {
+                if (commands_num == commands_capacity)
+                {
+                    commands_capacity = commands_capacity ? commands_capacity * 2 : 16;
+                    commands = realloc(commands, sizeof(struct spawned_command) * commands_capacity);
+                }
+                commands[commands_num++] = (struct spawned_command){reply.pid, polled[i].fd, reply.id};
+            }
+            send(polled[i].fd, &reply, sizeof(reply), MSG_NOSIGNAL);
+        }
+    }
+}
+
+// starts spawn helper, called at the very start so the helper is forked from a small process
+// if helper can't be started, minibash forks commands by itself
+void start_spawn_helper()
+{
+    int sockets[2];
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sockets) == -1)
+    {
+        return;
+    }
+
+    int helper_pid = fork();
+    if (helper_pid == 0)
+    {
+        close(sockets[0]);
+        run_spawn_helper(sockets[1]);
+    }
+
+    close(sockets[1]);
+    if (helper_pid == -1)
+    {
+        close(sockets[0]);
+        return;
+    }
+
+    spawn_helper_fd = sockets[0];
+    spawn_helper_owner = getpid();
+}
+
+// opens channel of interpreter to spawn helper
+// returns -1 on error
+int open_spawn_channel(struct minibash *interpreter)
+{
+    int sockets[2];
+    struct spawn_request request = {.id = 0, .argc = SPAWN_NEW_CHANNEL, .envc = 0};
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sockets) == -1)
+    {
+        return -1;
+    }
+    int ret_value = send_with_fds(spawn_helper_fd, &request, sizeof(request), &sockets[1], 1);
+    close(sockets[1]);
+    if (ret_value == -1)
+    {
+        close(sockets[0]);
+        return -1;
+    }
+    interpreter->spawn_channel_fd = sockets[0];
+    return 0;
+}
+
+// stop using spawn helper, i.e. when it has died
+void stop_spawn_helper(struct minibash *interpreter)
+{
+    close(interpreter->spawn_channel_fd);
+    interpreter->spawn_channel_fd = SPAWN_CHANNEL_BROKEN;
+}
+
+// runs command through spawn helper, redirections are done by opening the files here
+// and sending them to helper, minibash's own 0, 1, 2 are never changed
+// command starts with assignments_num NAME=value words, which are sent as environment changes
+// returns exit status of command, returns -2 if helper can't be used and command should be forked
+int spawn_with_helper(struct minibash *interpreter, char *command[], int assignments_num)
+{
+    if (spawn_helper_fd == -1 || spawn_helper_owner != getpid() ||
+        interpreter->spawn_channel_fd == SPAWN_CHANNEL_BROKEN)
+    {
+        return -2;
+    }
+    if (interpreter->spawn_channel_fd == -1 && open_spawn_channel(interpreter) == -1)
+    {
+        interpreter->spawn_channel_fd = SPAWN_CHANNEL_BROKEN;
+        return -2;
+    }
+
+    struct spawn_request request = {.id = ++spawn_request_id, .argc = 0, .envc = 0};
+    struct string_buffer message;
+    string_buffer_init(&message);
+    string_buffer_append_length(&message, (char *)&request, sizeof(request));
+    char *path = find_executable(interpreter, command[assignments_num]);
+    string_buffer_append_length(&message, path, strlen(path) + 1);
+    for (char **argument = command + assignments_num; *argument != NULL; argument++, request.argc++)
+    {
+        string_buffer_append_length(&message, *argument, strlen(*argument) + 1);
+    }
+
+    // helper has the environment minibash started with, so only send what has changed since
+    get_environment(interpreter);
+    for (char **change = interpreter->environment_delta_cache; *change != NULL; change++, request.envc++)
+    {
+        string_buffer_append_length(&message, *change, strlen(*change) + 1);
+    }
+    for (int i = 0; i < assignments_num; i++, request.envc++)
+    {
+        string_buffer_append_length(&message, command[i], strlen(command[i]) + 1);
+    }
+    memcpy(message.data, &request, sizeof(request));
+
+    if (message.length > SPAWN_MESSAGE_MAX)
+    {
+        string_buffer_free(&message);
+        return -2;
+    }
+
+    // work out what 0, 1 and 2 of command are
+    int fds[SPAWN_FDS] = {0, 1, 2, -1};
+    int opened[MAX_REDIRECTIONS + 1];
+    int opened_num = 0;
+    int status = -2;
+    struct spawn_reply reply;
+
+    // helper only gets 0, 1 and 2 of command, redirections of other file descriptors need a fork of minibash
+    for (int i = 0; i < redirections_num; i++)
+    {
+        if (redirections[i].fd > 2 || (redirections[i].kind == FD_ACTION_DUP && redirections[i].source_fd > 2))
+        {
+            string_buffer_free(&message);
+            return -2;
+        }
+    }
+
+    for (int i = 0; i < redirections_num; i++)
+    {
+        struct fd_action *action = &redirections[i];
+        int fd = action->kind == FD_ACTION_OPEN   ? open_redirection(interpreter, action, O_CLOEXEC)
+                 : action->kind == FD_ACTION_DATA ? open_data(interpreter, action, O_CLOEXEC)
+                                                  : fds[action->source_fd];
+
+        if (fd == -1)
+        {
+            status = 1 << 8; // same as child failing to redirect
+            goto cleanup;
+        }
+        if (action->kind != FD_ACTION_DUP)
+        {
+            opened[opened_num++] = fd;
+        }
+        fds[action->fd] = fd;
+    }
+
+    // directory of interpreter is kept open, it only has to be opened here when that failed
+    fds[3] = interpreter->cwd_fd;
+    if (fds[3] == -1 && (fds[3] = open(".", O_RDONLY | O_DIRECTORY | O_CLOEXEC)) != -1)
+    {
+        opened[opened_num++] = fds[3];
+    }
+
+    if (send_with_fds(interpreter->spawn_channel_fd, message.data, message.length, fds, fds[3] != -1 ? 4 : 3) == -1)
+    {
+        stop_spawn_helper(interpreter);
+        goto cleanup;
+    }
+
+    // wait for the reply telling command is done
+    while (true)
+    {
+        if (recv(interpreter->spawn_channel_fd, &reply, sizeof(reply), 0) != sizeof(reply))
+        {
+            if (errno == EINTR)
+                continue;
+            stop_spawn_helper(interpreter);
+            status = -1;
+            goto cleanup;
+        }
+        if (reply.id == request.id && reply.exited)
+            break;
+    }
+
+    status = reply.status;
+
+cleanup:
+    for (int i = 0; i < opened_num; i++)
+    {
+        close(opened[i]);
+    }
+    string_buffer_free(&message);
+    return status;
+}
+
+// forks and runs process in child
+int fork_and_run(struct minibash *interpreter, char *command[], char *input)
+{
+    // NAME=value words at the start are environment of command,
+    // without a command they set shell variables
+    int assignments_num = count_assignments(command);
+    char **environment;
+
+    // exec in place is only for the command of input itself, commands that functions and builtins like retry
+    // and watch run, maybe more than once, are forked
+    bool is_in_place = is_exec_in_place;
+    is_exec_in_place = false;
+
+    if (command[assignments_num] == NULL)
+    {
+        assign_variables(interpreter, command, assignments_num);
+        return 0;
+    }
+
+    if (input)
+    {
+        // functions come before builtins, both are found with one look up in name table
+        char *name = command[assignments_num];
+        struct name_entry *entry = find_name(interpreter, name, strlen(name), false);
+        selected_custom_command = entry && !entry->function ? entry->builtin : -1;
+
+        // functions and custom commands run in minibash, so their redirections are applied to it while they run
+        if ((entry && entry->function) || selected_custom_command != -1)
+        {
+            int saved[MAX_REDIRECTIONS];
+            int applied_num = redirections_num;
+            if (apply_redirections_in_place(interpreter, saved) == -1)
+            {
+                return 1 << 8;
+            }
+
+            // commands they start already have these file descriptors, so redirections are put aside
+            // until they're done, inputs they run have redirections of their own
+            struct fd_action applied[MAX_REDIRECTIONS];
+            memcpy(applied, redirections, sizeof(struct fd_action) * applied_num);
+            redirections_num = 0;
+
+            char **arguments = command + assignments_num;
+            int status = entry && entry->function ? run_function(interpreter, entry->function, arguments)
+                                                  : perform_custom_command(interpreter, arguments, input);
+
+            memcpy(redirections, applied, sizeof(struct fd_action) * applied_num);
+            redirections_num = applied_num;
+            restore_redirections(saved, applied_num);
+            return status;
+        }
+    }
+
+    // like sh -c, minibash -c true becomes true, which saves a fork and a wait
+    if (is_in_place && !is_fanout_command(command + assignments_num) && !has_command_limits())
+    {
+        environment = command_environment(interpreter, command, assignments_num);
+        command += assignments_num;
+        fflush(stdout);
+        exec_command(find_executable(interpreter, command[0]), command, environment);
+        printf("minibash: %s: command not found\n", command[0]);
+        fflush(stdout);
+        _exit(COMMAND_NOT_FOUND);
+    }
+
+    // let spawn helper fork when it's running, tee has to be forked by minibash
+    // and so do commands with a timeout or limits, which are enforced by minibash
+    if (!is_fanout_command(command + assignments_num) && !has_command_limits())
+    {
+        int status = spawn_with_helper(interpreter, command, assignments_num);
+        if (status != -2)
+        {
+            return status;
+        }
+    }
+
+    environment = command_environment(interpreter, command, assignments_num);
+    command += assignments_num;
+    char *path = find_executable(interpreter, command[0]);
+
+    fflush(stdout); // so child doesn't print what's still buffered in minibash
+    int child_pid = fork();
+
+    if (child_pid > 0)
+    {
+        // parent process
+        int status = wait_for_child(child_pid);
+        if (environment != interpreter->environment_cache)
+        {
+            free(environment);
+        }
+        return status;
+    }
+    else if (child_pid == 0)
+    {
+        // child process differentiate with given command
+        apply_redirections(interpreter);
+        apply_command_limits();
+        if (is_fanout_command(command))
+        {
+            _exit(run_fanout(command));
+        }
+        if (exec_command(path, command, environment) == -1)
+        {
+            // _exit so the child doesn't rewind a script minibash is reading
+            printf("minibash: %s: command not found\n", command[0]);
+            fflush(stdout);
+            _exit(COMMAND_NOT_FOUND);
+        }
+    }
+    else
+    {
+        printf("Fork Failed!\n");
+        if (environment != interpreter->environment_cache)
+        {
+            free(environment);
+        }
+        return -1;
+    }
+    return -1;
+}
+
+// for # [file.txt]
+// performs wc -w [args from command_1]
+// returns exit status of the child process which runs the command
+int count_words(struct minibash *interpreter)
+{
+    int command_length = find_command_length(command_1);
+
+    // at most 1 parameter i.e. total argument == 2
+    if (command_length > 2)
+    {
+        printf("minibash: #: Too many Arguments\n");
+        return -1;
+    }
+    else if (command_length == 0)
+    {
+        printf("minibash: #: No Arguments Passed\n");
+        return -1;
+    }
+    else
+    {
+
+        // words of command_1 are only pointed to, they're freed with it
+        char *command[5] = {"wc", "-w", NULL, NULL, NULL};
+        for (int i = 0; i < command_length; i++)
+        {
+            command[i + 2] = command_1[i];
+        }
+        return fork_and_run(interpreter, command, NULL);
+    }
+}
+
+// for + & fore
+// returns size of background_processes_pids
+int find_size(struct minibash *interpreter)
+{
+    int i = 0;
+    while (interpreter->background_processes_pids && interpreter->background_processes_pids[i] != -1)
+    {
+        i++;
+    }
+    return i;
+}
+
+// for fore
+int get_index(struct minibash *interpreter, int pid)
+{
+
+    int index = -1;
+    int i = 0;
+    int size = find_size(interpreter);
+
+    while (i < size)
+    {
+        if (pid == interpreter->background_processes_pids[i])
+        {
+            index = i;
+            break;
+        }
+        i++;
+    }
+    return index;
+}
+
+// for + and fore
+// get index and shift left in background_processes_pids
+// used in send_to_background & fore in perform_custom_command
+int get_index_and_shift(struct minibash *interpreter, int pid)
+{
+    int size = find_size(interpreter);
+    int i = 0;
+    int index = 0;
+    bool is_found = false;
+
+    // loop in array
+    while (i < size)
+    {
+        // if element is found, start shifting indexes
+        if (is_found)
+        {
+            // shift indexes from previous
+            interpreter->background_processes_pids[i] = interpreter->background_processes_pids[i + 1];
+        }
+        else
+        {
+            if (pid == interpreter->background_processes_pids[i])
+            {
+                index = i;
+                is_found = true;
+                interpreter->background_processes_pids[i] = interpreter->background_processes_pids[i + 1];
+            }
+        }
+        i++;
+    }
+    return index + 1;
+}
+
+// for +
+// sends a process to background, by making a named pipe
+// returns -1 on error
+int send_to_background(struct minibash *interpreter)
+{
+    int command_1_len = find_command_length(command_1);
+
+    // job list and stdin backup for fore are only made once something is sent to background
+    if (interpreter->background_processes_pids == NULL)
+    {
+        interpreter->background_processes_pids = malloc(sizeof(int) * 1000); // can have max 1000 background processes
+        interpreter->background_processes_pids[0] = -1;
+    }
+    backup_standard_fds();
+
+    // to ensure + is at the end of an argument
+    // at most 1 parameter i.e. total argument == 2
+    int i = 0;
+    while (i < command_1_len)
+    {
+        int size = find_size(interpreter);
+        int child_pid;
+        char *path = find_executable(interpreter, command_1[i]);
+
+        child_pid = fork();
+
+        if (child_pid > 0)
+        {
+            // parent process
+            interpreter->background_processes_pids[size] = child_pid; // save child pid to enter
+            interpreter->background_processes_pids[size + 1] = -1;    // set next index to be -1
+            printf("[%d] %d\n", size + 1, child_pid);    // print PID of child
+        }
+        else if (child_pid == 0)
+        {
+            // child process
+            // sever input of this process and send to below file, temporarily
+            int fd = open("/home/damlet/Desktop/asp_assignment/assignment_3/temp_file", O_CREAT | O_RDWR | O_CLOEXEC, 0777);
+            dup2(fd, 0);
+            signal(SIGCONT, handle_sigcont); // register sigcont
+            apply_redirections(interpreter);
+
+            char *command[] = {command_1[i], NULL};
+            int ret_value = exec_command(path, command, get_environment(interpreter)); // replace with command
+            if (ret_value == -1)
+            {
+                // _exit so the child doesn't rewind a script minibash is reading, COMMAND_NOT_FOUND is reported
+                // when the job is reaped
+                _exit(COMMAND_NOT_FOUND);
+            }
+        }
+        else
+        {
+            printf("Fork Failed\n");
+            return -1;
+        }
+        i++;
+    }
+    return 0;
+}
+
+// for <, >, >>
+// runs command_1 with fd redirected to file named in command_2
+// the redirection goes where it was written among the others, so > file 2>&1 and 2>&1 > file work like in bash,
+// for commands it is applied in child, so minibash's own file descriptors are never changed
+// returns exit status of the child process which runs the command
+// returns -1 on error
+int redirect_and_run(struct minibash *interpreter, char *input, int fd, int flags, char *missing_file_message,
+                     char *many_files_message)
+{
+    // only 2 commands can exist, since only 1 <, > or >> is allowed
+    int command_2_len = find_command_length(command_2);
+
+    if (!command_2[0])
+    {
+        printf("%s\n", missing_file_message);
+        return -1;
+    }
+
+    // command 1 can have at most 4 args, besides a prefix like timeout 5 (which is handled in tokenization part)
+    // command 2 will hold the file name
+    if (command_2_len > 1)
+    {
+        printf("%s\n", many_files_message);
+        return -1;
+    }
+
+    if (redirections_num == MAX_REDIRECTIONS)
+    {
+        printf("Program Only supports upto %d redirections in an input\n", MAX_REDIRECTIONS);
+        return -1;
+    }
+
+    // redirections written after <, > or >> move up to make space for it
+    int position = redirection_position <= redirections_num ? redirection_position : redirections_num;
+    memmove(&redirections[position + 1], &redirections[position], sizeof(struct fd_action) * (redirections_num - position));
+    redirections_num++;
+
+    redirections[position].kind = FD_ACTION_OPEN;
+    redirections[position].fd = fd;
+    redirections[position].source_fd = -1;
+    redirections[position].flags = flags;
+    redirections[position].path = strdup(command_2[0]);
+    redirections[position].command = 0;
+
+    // pass command 1 to execute, it can be a function or a builtin too
+    return fork_and_run(interpreter, command_1, input);
+}
+
+// for <
+// take input from a file, file must exist
+// returns exit status of the child process which runs the command
+/// returns -1 on error
+int input_from_file(struct minibash *interpreter, char *input)
+{
+    return redirect_and_run(interpreter, input, 0, O_RDONLY,
+                            "Provide the file name you want to take input from after '<'",
+                            "Can take Input from only 1 file");
+}
+
+// for >
+// write output of command to a file, file is created if it doesn't exist and truncated if it does
+// returns exit status of the child process which runs the command
+/// returns -1 on error
+int output_to_file(struct minibash *interpreter, char *input)
+{
+    return redirect_and_run(interpreter, input, 1, O_CREAT | O_WRONLY | O_TRUNC,
+                            "Provide the file name you want to put output in, after '>'",
+                            "Can write output to only 1 file");
+}
+
+// for >>
+// append output of command to a file, file must exist
+// O_APPEND makes every write of the command land at end of file
+// returns exit status of the child process which runs the command
+/// returns -1 on error
+int append_to_file(struct minibash *interpreter, char *input)
+{
+    return redirect_and_run(interpreter, input, 1, O_WRONLY | O_APPEND,
+                            "Provide the file name you want to take input from after '>>'",
+                            "Can take Input from only 1 file");
+}
+
+// for [file.txt] ~ [file.txt]
+// performs cat [args from command_1,2,3,4]
+// returns exit status of the child process which runs the command
+/// returns -1 on error
+int concatetnate_files(struct minibash *interpreter)
+{
+    int command_1_len = find_command_length(command_1);
+    int command_2_len = find_command_length(command_2);
+    int command_3_len = find_command_length(command_3);
+    int command_4_len = find_command_length(command_4);
+
+    if (command_1_len <= 1 && command_2_len <= 1 && command_3_len <= 1 && command_4_len <= 1)
+    {
+        // cat and a file of every command, words are only pointed to, they're freed with their commands
+        char *command[6] = {"cat", NULL, NULL, NULL, NULL, NULL};
+        for (int i = 0; i <= special_char_num; i++)
+        {
+            if (!all_commands_pointer[i][0])
+            {
+                printf("Usage: [file1.txt] ~ [file2.txt]\n");
+                return -1;
+            }
+            command[i + 1] = all_commands_pointer[i][0];
+        }
+        return fork_and_run(interpreter, command, NULL);
+    }
+    else
+    {
+        printf("Usage: [file1.txt] ~ [file2.txt]\n");
+        return -1;
+    }
+}
+
+// checks that all required commands exists
+// returns -1 on error
+// returns 1 on success
+int check_all_commands_exist(char *custom_message)
+{
+    int i = 0;
+    // check that all commands exists
+    while (i <= special_char_num)
+    {
+        if (all_commands_pointer[i][0])
+        {
+            i++;
+        }
+        else
+        {
+            printf("%s\n", custom_message);
+            return -1;
+        }
+    }
+    return 1;
+}
+
+// runs command i of commands joined by ;, && or ||, which is expanded only now, so it sees variables and $?
+// of the commands before it
+// returns exit status of command
+int run_chained_command(struct minibash *interpreter, int i, char *input)
+{
+    char ***commands[] = {&command_1, &command_2, &command_3, &command_4};
+    expand_command(interpreter, commands[i]);
+    all_commands_pointer[i] = *commands[i];
+    expand_here_documents(interpreter, i);
+
+    // only redirections written in command i apply to it, all are put back for the commands after it
+    struct fd_action all[MAX_REDIRECTIONS];
+    int all_num = redirections_num;
+    memcpy(all, redirections, sizeof(struct fd_action) * all_num);
+    select_redirections(i);
+    int ret_value = fork_and_run(interpreter, all_commands_pointer[i], input);
+    memcpy(redirections, all, sizeof(struct fd_action) * all_num);
+    redirections_num = all_num;
+    interpreter->last_exit_status = exit_code(ret_value);
+    return ret_value;
+}
+
+// for ;
+// returns exit status of last command
+// returns -1 on error
+int run_sequentially(struct minibash *interpreter, char *input)
+{
+    int i = 0;
+    int ret_value = 0;
+
+    if (check_all_commands_exist("Syntax Error, Unexpected token near ';'") == -1)
+    {
+        return -1;
+    }
+
+    i = 0;
+    // loop in all commands to run them one by one
+    while (i <= special_char_num && !interpreter->is_exit_requested)
+    {
+        ret_value = run_chained_command(interpreter, i, input);
+        i++;
+    }
+    return ret_value;
+}
+
+// for pipestats
+// returns seconds of CLOCK_MONOTONIC
+double monotonic_seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// moves what's in pipes of hop on with splice, data goes from pipe to pipe without being copied to minibash
+// closes pipe to next command once command before it is done writing
+void relay_hop(struct pipe_hop *hop)
+{
+    while (hop->from_fd != -1)
+    {
+        ssize_t moved = splice(hop->from_fd, NULL, hop->to_fd, NULL, RELAY_CHUNK, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (moved > 0)
+        {
+            hop->bytes += moved;
+            continue;
+        }
+        if (moved == -1 && errno == EAGAIN)
+        {
+            // nothing to read, or nowhere to write it
+            int pending = 0;
+            ioctl(hop->from_fd, FIONREAD, &pending);
+            hop->is_full = pending > 0;
+            return;
+        }
+        // end of output, or next command has gone away
+        close(hop->from_fd);
+        close(hop->to_fd);
+        hop->from_fd = -1;
+        hop->to_fd = -1;
+    }
+}
+
+// relays pipes of commands and waits for all of them, then prints report of every command to stderr
+// time of every wait is put on hop it waited for, pipe is full or next command has nothing to read
+// returns wait status of last command
+int relay_pipes(struct pipe_hop *hops, int hops_num, struct pipe_stage *stages, int stages_num, char ***commands)
+{
+    struct pollfd poll_fds[4 * 2]; // a pipe has at most 4 commands, so 3 hops
+    int status = 0, last_status = 0;
+    double last_time = monotonic_seconds();
+
+    while (true)
+    {
+        int fds_num = 0;
+        for (int i = 0; i < hops_num; i++)
+        {
+            if (hops[i].from_fd != -1)
+            {
+                poll_fds[fds_num].fd = hops[i].is_full ? hops[i].to_fd : hops[i].from_fd;
+                poll_fds[fds_num++].events = hops[i].is_full ? POLLOUT : POLLIN;
+            }
+        }
+        for (int i = 0; i < stages_num; i++)
+        {
+            if (stages[i].pid_fd != -1)
+            {
+                poll_fds[fds_num].fd = stages[i].pid_fd;
+                poll_fds[fds_num++].events = POLLIN;
+            }
+        }
+        if (fds_num == 0)
+        {
+            break;
+        }
+        // commands whose pidfd couldn't be opened are waited for once everything else is done
+
+        if (poll(poll_fds, fds_num, -1) == -1 && errno != EINTR)
+        {
+            break;
+        }
+
+        double now = monotonic_seconds();
+        for (int i = 0; i < hops_num; i++)
+        {
+            if (hops[i].from_fd != -1)
+            {
+                *(hops[i].is_full ? &hops[i].write_wait : &hops[i].read_wait) += now - last_time;
+                relay_hop(&hops[i]);
+            }
+        }
+        last_time = now;
+
+        for (int i = 0; i < stages_num; i++)
+        {
+            struct rusage usage;
+            if (stages[i].pid_fd != -1 && wait4(stages[i].pid, &status, WNOHANG, &usage) == stages[i].pid)
+            {
+                close(stages[i].pid_fd);
+                stages[i].pid_fd = -1;
+                stages[i].end = now;
+                stages[i].cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                                usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+                if (i == stages_num - 1)
+                {
+                    last_status = status;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < stages_num; i++)
+    {
+        struct rusage usage;
+        if (stages[i].end == 0 && wait4(stages[i].pid, &status, 0, &usage) == stages[i].pid)
+        {
+            stages[i].end = monotonic_seconds();
+            stages[i].cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                            usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+            if (i == stages_num - 1)
+            {
+                last_status = status;
+            }
+        }
+    }
+
+    fprintf(stderr, "%-6s %9s %9s %12s %10s %10s %10s  %s\n",
+            "stage", "wall(s)", "cpu(s)", "out(bytes)", "out(MB/s)", "read(s)", "write(s)", "command");
+    for (int i = 0; i < stages_num; i++)
+    {
+        double wall = stages[i].end - stages[i].start;
+        long long bytes = i < hops_num ? hops[i].bytes : 0;
+        char *name = commands[i][count_assignments(commands[i])];
+        fprintf(stderr, "%-6d %9.3f %9.3f %12lld %10.1f %10.3f %10.3f  %s\n", i + 1, wall, stages[i].cpu, bytes,
+                wall > 0 ? bytes / wall / 1e6 : 0, i > 0 ? hops[i - 1].read_wait : 0,
+                i < hops_num ? hops[i].write_wait : 0, name ? name : "");
+    }
+    return last_status;
+}
+
+// run pipes
+// all commands are started first and run at the same time, then minibash waits for all of them
+// returns exit status of last command
+int run_pipes(struct minibash *interpreter)
+{
+    // check that all commands exist
+    if (check_all_commands_exist("Syntax Error, Unexpected token near '|'") == -1)
+    {
+        return -1;
+    }
+    backup_standard_fds();
+
+    int status = 0;
+    int fd[2];
+    int previous_read = 0;
+    int child_pids[4];
+    int started = 0;
+
+    // with pipestats every command writes to a pipe of its own, which minibash relays to next command
+    struct pipe_hop hops[3];
+    struct pipe_stage stages[4];
+    int relay_fd[2];
+
+    fflush(stdout); // so children running functions or tee don't print what's still buffered in minibash
+    for (int i = 0; i <= special_char_num; i++)
+    {
+        // if last command don't create pipe
+        if (i != special_char_num)
+        {
+            if (make_pipe(interpreter, fd, O_CLOEXEC) == -1)
+            {
+                printf("Pipe Failed\n");
+                break;
+            }
+            if (interpreter->pipestats)
+            {
+                if (make_pipe(interpreter, relay_fd, O_CLOEXEC | O_NONBLOCK) == -1)
+                {
+                    printf("Pipe Failed\n");
+                    close(fd[0]);
+                    close(fd[1]);
+                    break;
+                }
+                // command writes to fd[1], minibash moves it from fd[0] to relay_fd[1], next command reads relay_fd[0]
+                fcntl(fd[0], F_SETFL, O_NONBLOCK);
+                fcntl(relay_fd[0], F_SETFL, 0);
+                hops[i] = (struct pipe_hop){fd[0], relay_fd[1], 0, 0, 0, false};
+                fd[0] = relay_fd[0];
+            }
+        }
+
+        // looked up before fork, so that it stays cached for next time
+        char **stage = all_commands_pointer[i] + count_assignments(all_commands_pointer[i]);
+        char *path = stage[0] ? find_executable(interpreter, stage[0]) : NULL;
+
+        int child_pid = fork();
+
+        if (child_pid > 0)
+        {
+            // parent process
+            // close pipe ends once child has them, so no pipe end stays open in minibash
+            if (interpreter->pipestats)
+            {
+                stages[started] = (struct pipe_stage){child_pid, syscall(SYS_pidfd_open, child_pid, 0), monotonic_seconds(), 0, 0};
+            }
+            child_pids[started++] = child_pid;
+            if (previous_read != 0)
+            {
+                close(previous_read);
+            }
+            if (i != special_char_num)
+            {
+                close(fd[1]);          // close write for pipe
+                previous_read = fd[0]; // copy pipe's read so that next iteration, new command can read from it
+            }
+        }
+        else if (child_pid == 0)
+        {
+            // child process
+            // relayed pipe ends are minibash's, a function run here mustn't keep them open
+            for (int j = 0; interpreter->pipestats && j <= i && j < special_char_num; j++)
+            {
+                close(hops[j].from_fd);
+                close(hops[j].to_fd);
+            }
+            dup2(previous_read, 0); // change input to pipe's read
+
+            // check if it's not last command
+            if (i == special_char_num)
+            {
+                dup2(stdout_fd_backup, 1); // redirect output back to stdout
+            }
+            else
+            {
+                close(fd[0]);   // close current pipe input
+                dup2(fd[1], 1); // change output to pipe's write
+            }
+
+            select_redirections(i); // only those written in this command
+            apply_redirections(interpreter);   // i.e. 2>&1 after output is connected to pipe
+            redirections_num = 0; // commands a function or timeout starts from here don't apply them again
+
+            // NAME=value words at the start are environment of the command
+            char **command = all_commands_pointer[i];
+            int assignments_num = count_assignments(command);
+            char **environment = command_environment(interpreter, command, assignments_num);
+            command += assignments_num;
+
+            if (command[0] == NULL)
+            {
+                _exit(0);
+            }
+
+            // tee is done by minibash itself
+            if (is_fanout_command(command))
+            {
+                _exit(run_fanout(command));
+            }
+
+            // a function runs in this child, like any other command of the pipe
+            struct name_entry *entry = find_name(interpreter, command[0], strlen(command[0]), false);
+            if (entry && entry->function)
+            {
+                int status = run_function(interpreter, entry->function, command);
+                fflush(stdout);
+                _exit(exit_code(status));
+            }
+
+            // so do timeout, retry and limit, which minibash enforces itself instead of running a program for them
+            int (*prefix_command)(struct minibash *, char *[], char *) =
+                strcmp(command[0], "timeout") == 0 ? timeout_command
+                : strcmp(command[0], "retry") == 0 ? retry_command
+                : strcmp(command[0], "limit") == 0 ? limit_command
+                                                   : NULL;
+            if (prefix_command)
+            {
+                int status = prefix_command(interpreter, command, NULL);
+                fflush(stdout);
+                _exit(exit_code(status));
+            }
+
+            int exec_fail = exec_command(path, command, environment); // differentiate with execvp
+
+            if (exec_fail == -1)
+            {
+                fprintf(stderr, "minibash: %s: command not found\n", command[0]);
+                _exit(COMMAND_NOT_FOUND);
+            }
+        }
+        else
+        {
+            printf("Fork Failed\n");
+            if (i != special_char_num)
+            {
+                close(fd[0]);
+                close(fd[1]);
+                if (interpreter->pipestats)
+                {
+                    close(hops[i].from_fd);
+                    close(hops[i].to_fd);
+                }
+            }
+            break;
+        }
+    }
+
+    if (interpreter->pipestats && started == special_char_num + 1)
+    {
+        return relay_pipes(hops, special_char_num, stages, started, all_commands_pointer);
+    }
+    for (int i = 0; interpreter->pipestats && i < started && i < special_char_num; i++)
+    {
+        close(hops[i].from_fd);
+        close(hops[i].to_fd);
+    }
+
+    if (previous_read != 0 && started != special_char_num + 1)
+    {
+        close(previous_read);
+    }
+
+    // wait for all commands, status of the pipeline is status of the last command
+    for (int i = 0; i < started; i++)
+    {
+        waitpid(child_pids[i], &status, 0);
+    }
+
+    return started == special_char_num + 1 ? status : -1;
+}
+
+// for &&
+// returns exit status of last command
+// returns -1 on error
+int run_and_command(struct minibash *interpreter, char *input)
+{
+    int ret_value = 0;
+    int i = 0;
+
+    if (check_all_commands_exist("Syntax Error, Unexpected token near '&&'") == -1)
+    {
+        return -1;
+    }
+
+    i = 0;
+    // pass command one by one and only if previous command's return status is 0(i.e. executes sucessfully), execute next command
+    while (i <= special_char_num && ret_value == 0 && !interpreter->is_exit_requested)
+    {
+        ret_value = run_chained_command(interpreter, i, input);
+        i++;
+    }
+
+    return ret_value;
+}
+
+// for || and multiple conditionals
+// returns exit status of last command
+// returns -1 on error
+int run_or_command(struct minibash *interpreter, char *input)
+{
+    if (check_all_commands_exist("Syntax Error, Unexpected token near '||' ") == -1)
+    {
+        return -1;
+    }
+
+    if (is_multiple_conditional)
+    {
+        int ret_value = -1;
+        // if there are multiple conditionals
+        int i = 0;
+
+        while (i <= special_char_num && !interpreter->is_exit_requested)
+        {
+            // check condtionals, after  1st command runs
+            if (i >= 1)
+            {
+                // i-1 th because for at most 4 commands there will be only 3 condtionals
+                if (multiple_conditionals_sequence[i - 1] == false)
+                {
+                    // false represents and
+                    // if last command didn't run successfully, skip this command, else run
+                    if (ret_value != 0)
+                    {
+                        ret_value = -1;
+                    }
+                    else
+                    {
+                        ret_value = run_chained_command(interpreter, i, input);
+                    }
+                }
+                else
+                {
+                    // true represents or
+                    // if last command didn't ran successfully, then run
+                    if (ret_value != 0)
+                    {
+                        ret_value = run_chained_command(interpreter, i, input);
+                    }
+                }
+            }
+            else
+            {
+                // always run 1st command
+                ret_value = run_chained_command(interpreter, i, input);
+            }
+            i++;
+        }
+
+        return ret_value;
+    }
+    else
+    {
+        int ret_value = -1;
+        int i = 0;
+
+        // pass command one by one and only if previous command's return status is -1 (i.e. fails) execute next command
+        while (i <= special_char_num && ret_value != 0 && !interpreter->is_exit_requested)
+        {
+            ret_value = run_chained_command(interpreter, i, input);
+            i++;
+        }
+
+        return ret_value;
+    }
+}
+
+// performs commands according to commands stored in command_1,2,3,4 according to selected special character
+int run_commands(struct minibash *interpreter, char *input)
+{
+    // for ~ extension of cd and pushd to work, any other special character after them runs as usual
+    if (is_special_char && selected_special_char == 5 && special_char_num == 1 && command_1[0] &&
+        (strcmp(command_1[0], "cd") == 0 || strcmp(command_1[0], "pushd") == 0))
+    {
+        is_special_char = false;
+    }
+
+    // if special char, loop and perform commands
+    if (is_special_char)
+    {
+        switch (selected_special_char)
+        {
+        case 0:
+            // for #
+            // if number of args > 2, show error
+            return count_words(interpreter);
+            break;
+        case 1:
+            // for +
+            return send_to_background(interpreter);
+            break;
+        case 2:
+            // for <
+            return input_from_file(interpreter, input);
+            break;
+        case 3:
+            // for >
+            return output_to_file(interpreter, input);
+            break;
+        case 4:
+            // for >>
+            return append_to_file(interpreter, input);
+            break;
+        case 5:
+            // for ~
+            return concatetnate_files(interpreter);
+            break;
+        case 6:
+            // for ;
+            return run_sequentially(interpreter, input);
+            break;
+        case 7:
+            // for |
+            return run_pipes(interpreter);
+            break;
+        case 8:
+            // for &&
+            return run_and_command(interpreter, input);
+            break;
+        case 9:
+            // for ||
+            return run_or_command(interpreter, input);
+            break;
+        default:
+            break;
+        }
+    }
+    else
+    {
+        return fork_and_run(interpreter, command_1, input);
+    }
+    return 1;
+}
+
+// starts process substitutions, performs commands and cleans up process substitutions
+// returns -1 on error
+int perform_commands(struct minibash *interpreter, char *input)
+{
+    int ret_value = -1;
+
+    if (start_substitutions(interpreter) != -1)
+    {
+        ret_value = run_commands(interpreter, input);
+    }
+
+    finish_substitutions();
+    return ret_value;
+}
+
+// SCRIPTS
+// parses input into plan, so that it can be run any number of times without parsing it again
+// returns 1 on success, 0 if input is empty, -1 on error, errors are printed here
+int compile_plan(struct minibash *interpreter, struct command_plan *plan, char *text)
+{
+    struct string_buffer input;
+    string_buffer_init(&input);
+    string_buffer_append(&input, text);
+    expand_aliases(interpreter, &input);
+
+    plan->input = NULL;
+    plan->state = 1;
+
+    char *custom_delimiters = input_parsing(&input);
+    if (custom_delimiters == NULL)
+    {
+        plan->state = input.length > 0 ? -1 : 0;
+    }
+    else if (tokenize_commands(input.data, custom_delimiters) == -1)
+    {
+        printf("Only 3 Parametes allowed for any Command\n");
+        plan->state = -1;
+    }
+    else if (validate_commands() == -1)
+    {
+        plan->state = -1;
+    }
+
+    if (custom_delimiters != NULL && custom_delimiters != default_delimiters)
+    {
+        free(custom_delimiters);
+    }
+    if (plan->state != 1)
+    {
+        reset();
+        string_buffer_free(&input);
+        return plan->state;
+    }
+
+    // plan takes over everything parsing left in globals, so reset doesn't free it
+    plan->input = input.data;
+    plan->selected_special_char = selected_special_char;
+    plan->special_char_num = special_char_num;
+    plan->is_special_char = is_special_char;
+    plan->is_conditional = is_conditional;
+    plan->is_multiple_conditional = is_multiple_conditional;
+    memcpy(plan->multiple_conditionals_sequence, multiple_conditionals_sequence, sizeof(multiple_conditionals_sequence));
+
+    char ***commands[] = {&command_1, &command_2, &command_3, &command_4};
+    for (int i = 0; i < 4; i++)
+    {
+        plan->commands[i] = *commands[i];
+        *commands[i] = empty_command;
+    }
+
+    memcpy(plan->redirections, redirections, sizeof(struct fd_action) * redirections_num);
+    plan->redirections_num = redirections_num;
+    plan->redirection_position = redirection_position;
+    redirections_num = 0;
+    memcpy(plan->substitutions, substitutions, sizeof(struct process_substitution) * substitutions_num);
+    plan->substitutions_num = substitutions_num;
+    substitutions_num = 0;
+
+    reset();
+    return 1;
+}
+
+// runs plan once, as if its input was typed again
+// returns exit code of commands, which is also saved for $?
+int run_plan(struct minibash *interpreter, struct command_plan *plan)
+{
+    if (plan->state != 1)
+    {
+        if (plan->state == -1)
+        {
+            interpreter->last_exit_status = 1;
+        }
+        return interpreter->last_exit_status;
+    }
+
+    selected_special_char = plan->selected_special_char;
+    special_char_num = plan->special_char_num;
+    is_special_char = plan->is_special_char;
+    is_conditional = plan->is_conditional;
+    is_multiple_conditional = plan->is_multiple_conditional;
+    memcpy(multiple_conditionals_sequence, plan->multiple_conditionals_sequence, sizeof(multiple_conditionals_sequence));
+
+    // commands change what they are given, so they get copies
+    char ***commands[] = {&command_1, &command_2, &command_3, &command_4};
+    for (int i = 0; i < 4; i++)
+    {
+        *commands[i] = copy_command(plan->commands[i]);
+    }
+    if (is_special_char)
+    {
+        all_commands_pointer = calloc(5, sizeof(char **));
+        for (int i = 0; i <= special_char_num && i < 4; i++)
+        {
+            all_commands_pointer[i] = *commands[i];
+        }
+    }
+
+    for (int i = 0; i < plan->redirections_num; i++)
+    {
+        redirections[i] = plan->redirections[i];
+        redirections[i].path = plan->redirections[i].path ? strdup(plan->redirections[i].path) : NULL;
+    }
+    redirections_num = plan->redirections_num;
+    redirection_position = plan->redirection_position;
+    for (int i = 0; i < plan->substitutions_num; i++)
+    {
+        substitutions[i] = plan->substitutions[i];
+        substitutions[i].command = strdup(plan->substitutions[i].command);
+    }
+    substitutions_num = plan->substitutions_num;
+
+    expand_commands(interpreter);
+
+    char *input = strdup(plan->input);
+    int status = perform_commands(interpreter, input);
+    free(input);
+    reset();
+    reap_background_processes(interpreter);
+
+    interpreter->last_exit_status = exit_code(status);
+    return interpreter->last_exit_status;
+}
+
+void free_plan(struct command_plan *plan)
+{
+    if (plan->state == 1)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            free_command(plan->commands[i]);
+        }
+        for (int i = 0; i < plan->redirections_num; i++)
+        {
+            free(plan->redirections[i].path);
+        }
+        for (int i = 0; i < plan->substitutions_num; i++)
+        {
+            free(plan->substitutions[i].command);
+        }
+    }
+    free(plan->input);
+    free(plan);
+}
+
+// returns keyword text starts with, KEYWORD_NONE if there is none
+// rest is set to what follows the keyword
+int find_keyword(char *text, char **rest)
+{
+    for (int i = 0; i < KEYWORDS; i++)
+    {
+        size_t length = strlen(keywords[i]);
+        if (strncmp(text, keywords[i], length) == 0 && (text[length] == '\0' || text[length] == ' ' || text[length] == '\t'))
+        {
+            *rest = text + length;
+            while (**rest == ' ' || **rest == '\t')
+            {
+                (*rest)++;
+            }
+            return i;
+        }
+    }
+    return KEYWORD_NONE;
+}
+
+// returns length of NAME if text starts with NAME() or NAME (), 0 otherwise
+// rest is set to what follows the brackets
+size_t function_name_length(char *text, char **rest)
+{
+    size_t length = 0;
+    while (is_name_char(text[length], length == 0))
+    {
+        length++;
+    }
+
+    char *c = text + length;
+    while (*c == ' ' || *c == '\t')
+    {
+        c++;
+    }
+    if (length == 0 || c[0] != '(' || c[1] != ')')
+    {
+        return 0;
+    }
+
+    *rest = c + 2;
+    return length;
+}
+
+// adds a piece, text is copied without trailing whitespaces
+void push_piece(struct script_pieces *pieces, int keyword, char *text)
+{
+    size_t length = strlen(text);
+    while (length > 0 && (text[length - 1] == ' ' || text[length - 1] == '\t'))
+    {
+        length--;
+    }
+
+    if (pieces->count == pieces->capacity)
+    {
+        pieces->capacity = pieces->capacity ? pieces->capacity * 2 : 16;
+        pieces->pieces = realloc(pieces->pieces, sizeof(struct script_piece) * pieces->capacity);
+    }
+    pieces->pieces[pieces->count].keyword = keyword;
+    pieces->pieces[pieces->count].text = strndup(text, length);
+    pieces->count++;
+}
+
+// adds part of a line between two ;
+// do, then, else, done and fi can be followed by more on the same part, i.e. do echo $x
+void add_segment(struct script_pieces *pieces, char *segment)
+{
+    while (true)
+    {
+        while (*segment == ' ' || *segment == '\t')
+        {
+            segment++;
+        }
+        if (*segment == '\0')
+        {
+            return;
+        }
+
+        char *rest;
+        int keyword = find_keyword(segment, &rest);
+        size_t name_length = keyword == KEYWORD_NONE ? function_name_length(segment, &rest) : 0;
+        if (name_length > 0)
+        {
+            segment[name_length] = '\0';
+            keyword = KEYWORD_FUNCTION;
+        }
+
+        switch (keyword)
+        {
+        case KEYWORD_NONE:
+            push_piece(pieces, keyword, segment);
+            return;
+        case KEYWORD_FUNCTION:
+            pieces->depth++;
+            push_piece(pieces, keyword, segment);
+            break;
+        case KEYWORD_FOR:
+        case KEYWORD_WHILE:
+        case KEYWORD_UNTIL:
+        case KEYWORD_IF:
+            pieces->depth++;
+            push_piece(pieces, keyword, rest);
+            return;
+        case KEYWORD_ELIF:
+            push_piece(pieces, keyword, rest);
+            return;
+        case KEYWORD_FI:
+        case KEYWORD_DONE:
+        case KEYWORD_CLOSE_BRACE:
+            pieces->depth--;
+            push_piece(pieces, keyword, "");
+            break;
+        default:
+            push_piece(pieces, keyword, "");
+            break;
+        }
+        segment = rest;
+    }
+}
+
+// adds a line to pieces, a line outside of loops, conditionals and functions stays one piece,
+// so it's parsed like it always is, lines of loops, conditionals and functions are split at ;
+void add_script_text(struct script_pieces *pieces, char *line)
+{
+    char *rest;
+
+    while (*line == ' ' || *line == '\t')
+    {
+        line++;
+    }
+    if (*line == '\0')
+    {
+        return;
+    }
+    if (pieces->depth == 0 && find_keyword(line, &rest) == KEYWORD_NONE && function_name_length(line, &rest) == 0)
+    {
+        push_piece(pieces, KEYWORD_NONE, line);
+        return;
+    }
+
+    // ; inside brackets belongs to a process substitution, ; in a here document to the document
+    char *copy = strdup(line);
+    char *start = copy;
+    int brackets = 0;
+    for (char *c = copy;; c++)
+    {
+        if (*c == HERE_DOCUMENT_MARKER)
+        {
+            c += strlen(c) - 1;
+        }
+        else if (*c == '(')
+        {
+            brackets++;
+        }
+        else if (*c == ')' && brackets > 0)
+        {
+            brackets--;
+        }
+        else if ((*c == ';' && brackets == 0) || *c == '\0')
+        {
+            bool is_end = *c == '\0';
+            *c = '\0';
+            add_segment(pieces, start);
+            if (is_end)
+            {
+                break;
+            }
+            start = c + 1;
+        }
+    }
+    free(copy);
+}
+
+// adds line of input to pieces, with bodies of its here documents after it, bodies can be NULL
+void add_script_line(struct script_pieces *pieces, char *line, char *bodies)
+{
+    if (!bodies)
+    {
+        add_script_text(pieces, line);
+        return;
+    }
+
+    size_t line_length = strlen(line);
+    char *text = malloc(line_length + strlen(bodies) + 1);
+    memcpy(text, line, line_length);
+    strcpy(text + line_length, bodies);
+    add_script_text(pieces, text);
+    free(text);
+}
+
+void clear_pieces(struct script_pieces *pieces)
+{
+    for (int i = 0; i < pieces->count; i++)
+    {
+        free(pieces->pieces[i].text);
+    }
+    pieces->count = 0;
+    pieces->depth = 0;
+}
+
+// returns a new zeroed statement at end of list
+struct statement *push_statement(struct statement_list *list)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 4;
+        list->statements = realloc(list->statements, sizeof(struct statement) * list->capacity);
+    }
+    memset(&list->statements[list->count], 0, sizeof(struct statement));
+    return &list->statements[list->count++];
+}
+
+void free_statements(struct statement_list *list)
+{
+    for (int i = 0; i < list->count; i++)
+    {
+        struct statement *statement = &list->statements[i];
+        free(statement->text);
+        free(statement->name);
+        free_command(statement->words);
+        release_function(statement->function);
+        if (statement->plan)
+        {
+            free_plan(statement->plan);
+        }
+        free_statements(&statement->condition);
+        free_statements(&statement->body);
+        free_statements(&statement->else_body);
+    }
+    free(list->statements);
+    list->statements = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+int parse_statements(struct script_pieces *pieces, int *position, struct statement_list *list, int stop_keywords);
+
+// parses statements into list up to keyword expected, which is skipped
+// returns -1 on syntax error
+int parse_until(struct script_pieces *pieces, int *position, struct statement_list *list, int stop_keywords, int expected)
+{
+    int keyword = parse_statements(pieces, position, list, stop_keywords);
+    if (keyword == -2)
+    {
+        return -1;
+    }
+    if (keyword != expected)
+    {
+        if (keyword == KEYWORD_NONE)
+        {
+            printf("Syntax Error, '%s' expected\n", keywords[expected]);
+        }
+        else
+        {
+            printf("Syntax Error, Unexpected token near '%s'\n", keywords[keyword]);
+        }
+        return -1;
+    }
+    (*position)++;
+    return 1;
+}
+
+// parses condition of while, until, if or elif, text is what follows the keyword
+// returns -1 on syntax error
+int parse_condition(struct script_pieces *pieces, int *position, char *text, struct statement_list *condition, int expected)
+{
+    if (text[0] != '\0')
+    {
+        struct statement *statement = push_statement(condition);
+        statement->kind = STATEMENT_COMMAND;
+        statement->text = strdup(text);
+    }
+    if (parse_until(pieces, position, condition, 1 << expected, expected) == -1)
+    {
+        return -1;
+    }
+    if (condition->count == 0)
+    {
+        printf("Syntax Error, Unexpected token near '%s'\n", keywords[expected]);
+        return -1;
+    }
+    return 1;
+}
+
+// parses for NAME in WORDS, text is what follows for
+// returns -1 on syntax error
+int parse_for(struct script_pieces *pieces, int *position, char *text, struct statement *statement)
+{
+    statement->kind = STATEMENT_FOR;
+
+    char *copy = strdup(text);
+    if (hide_command_substitutions(copy) == -1)
+    {
+        free(copy);
+        return -1;
+    }
+    char *rest;
+    char *name = strtok_r(copy, default_delimiters, &rest);
+    char *in = name ? strtok_r(NULL, default_delimiters, &rest) : NULL;
+    if (!name || !in || strcmp(in, "in") != 0)
+    {
+        printf("Syntax Error, for NAME in WORDS expected\n");
+        free(copy);
+        return -1;
+    }
+    statement->name = strdup(name);
+
+    struct word_list words;
+    word_list_init(&words);
+    for (char *word = strtok_r(NULL, default_delimiters, &rest); word; word = strtok_r(NULL, default_delimiters, &rest))
+    {
+        word_list_push(&words, strdup(word));
+    }
+    statement->words = word_list_finish(&words);
+    free(copy);
+
+    // name has to be usable as NAME=value
+    for (int i = 0; statement->name[i] != '\0'; i++)
+    {
+        if (!is_name_char(statement->name[i], i == 0))
+        {
+            printf("Syntax Error, for NAME in WORDS expected\n");
+            return -1;
+        }
+    }
+
+    if (*position >= pieces->count || pieces->pieces[*position].keyword != KEYWORD_DO)
+    {
+        printf("Syntax Error, 'do' expected\n");
+        return -1;
+    }
+    (*position)++;
+    return parse_until(pieces, position, &statement->body, 1 << KEYWORD_DONE, KEYWORD_DONE);
+}
+
+// parses if or elif with its branches, up to and including fi
+// returns -1 on syntax error
+int parse_if(struct script_pieces *pieces, int *position, char *text, struct statement *statement)
+{
+    statement->kind = STATEMENT_IF;
+    if (parse_condition(pieces, position, text, &statement->condition, KEYWORD_THEN) == -1)
+    {
+        return -1;
+    }
+
+    int keyword = parse_statements(pieces, position, &statement->body, (1 << KEYWORD_ELIF) | (1 << KEYWORD_ELSE) | (1 << KEYWORD_FI));
+    if (keyword == -2)
+    {
+        return -1;
+    }
+    if (keyword == KEYWORD_NONE)
+    {
+        printf("Syntax Error, 'fi' expected\n");
+        return -1;
+    }
+
+    char *elif_text = pieces->pieces[*position].text;
+    (*position)++;
+    if (keyword == KEYWORD_ELIF)
+    {
+        return parse_if(pieces, position, elif_text, push_statement(&statement->else_body));
+    }
+    if (keyword == KEYWORD_ELSE)
+    {
+        return parse_until(pieces, position, &statement->else_body, 1 << KEYWORD_FI, KEYWORD_FI);
+    }
+    return 1;
+}
+
+// parses NAME() { COMMANDS }, name is NAME
+// returns -1 on syntax error
+int parse_function(struct script_pieces *pieces, int *position, char *name, struct statement *statement)
+{
+    statement->kind = STATEMENT_FUNCTION;
+    statement->name = strdup(name);
+    statement->function = calloc(1, sizeof(struct function));
+    statement->function->references = 1;
+
+    if (*position >= pieces->count || pieces->pieces[*position].keyword != KEYWORD_OPEN_BRACE)
+    {
+        printf("Syntax Error, '{' expected\n");
+        return -1;
+    }
+    (*position)++;
+    return parse_until(pieces, position, &statement->function->body, 1 << KEYWORD_CLOSE_BRACE, KEYWORD_CLOSE_BRACE);
+}
+
+// parses pieces into list, from position until end or until one of stop_keywords, a bit mask of KEYWORD_*
+// returns keyword it stopped at, KEYWORD_NONE at end of pieces and -2 on syntax error
+int parse_statements(struct script_pieces *pieces, int *position, struct statement_list *list, int stop_keywords)
+{
+    while (*position < pieces->count)
+    {
+        struct script_piece *piece = &pieces->pieces[*position];
+        if (piece->keyword != KEYWORD_NONE && (stop_keywords & (1 << piece->keyword)))
+        {
+            return piece->keyword;
+        }
+        (*position)++;
+
+        struct statement *statement = push_statement(list);
+        int ret_value = 1;
+        switch (piece->keyword)
+        {
+        case KEYWORD_NONE:
+            statement->kind = STATEMENT_COMMAND;
+            statement->text = strdup(piece->text);
+            break;
+        case KEYWORD_FOR:
+            ret_value = parse_for(pieces, position, piece->text, statement);
+            break;
+        case KEYWORD_WHILE:
+        case KEYWORD_UNTIL:
+            statement->kind = piece->keyword == KEYWORD_WHILE ? STATEMENT_WHILE : STATEMENT_UNTIL;
+            ret_value = parse_condition(pieces, position, piece->text, &statement->condition, KEYWORD_DO);
+            if (ret_value != -1)
+            {
+                ret_value = parse_until(pieces, position, &statement->body, 1 << KEYWORD_DONE, KEYWORD_DONE);
+            }
+            break;
+        case KEYWORD_IF:
+            ret_value = parse_if(pieces, position, piece->text, statement);
+            break;
+        case KEYWORD_FUNCTION:
+            ret_value = parse_function(pieces, position, piece->text, statement);
+            break;
+        default:
+            printf("Syntax Error, Unexpected token near '%s'\n", keywords[piece->keyword]);
+            ret_value = -1;
+            break;
+        }
+
+        if (ret_value == -1)
+        {
+            return -2;
+        }
+    }
+    return KEYWORD_NONE;
+}
+
+int run_statements(struct minibash *interpreter, struct statement_list *list);
+
+// runs a statement, commands are compiled the first time they run and reused after that
+// returns exit code of statement, which is also saved for $?
+int run_statement(struct minibash *interpreter, struct statement *statement)
+{
+    int code = 0;
+
+    switch (statement->kind)
+    {
+    case STATEMENT_COMMAND:
+        if (!statement->plan)
+        {
+            statement->plan = malloc(sizeof(struct command_plan));
+            compile_plan(interpreter, statement->plan, statement->text);
+        }
+        return run_plan(interpreter, statement->plan);
+    case STATEMENT_FOR:
+    {
+        struct word_list list;
+        word_list_init(&list);
+        for (int i = 0; statement->words[i] != NULL; i++)
+        {
+            expand_argument(interpreter, statement->words[i], &list);
+        }
+        char **values = word_list_finish(&list);
+        for (int i = 0; values[i] != NULL && !interpreter->is_exit_requested; i++)
+        {
+            set_variable(interpreter, statement->name, strlen(statement->name), values[i], false);
+            code = run_statements(interpreter, &statement->body);
+        }
+        free_command(values);
+        break;
+    }
+    case STATEMENT_WHILE:
+    case STATEMENT_UNTIL:
+        while (!interpreter->is_exit_requested &&
+               (run_statements(interpreter, &statement->condition) == 0) == (statement->kind == STATEMENT_WHILE))
+        {
+            code = run_statements(interpreter, &statement->body);
+        }
+        break;
+    case STATEMENT_FUNCTION:
+        define_function(interpreter, statement->name, statement->function);
+        break;
+    case STATEMENT_IF:
+        if (run_statements(interpreter, &statement->condition) == 0)
+        {
+            code = run_statements(interpreter, &statement->body);
+        }
+        else
+        {
+            code = run_statements(interpreter, &statement->else_body);
+        }
+        break;
+    }
+
+    interpreter->last_exit_status = code;
+    return code;
+}
+
+// runs statements one after another, returns exit code of the last one
+int run_statements(struct minibash *interpreter, struct statement_list *list)
+{
+    int code = 0;
+    for (int i = 0; i < list->count && !interpreter->is_exit_requested; i++)
+    {
+        code = run_statement(interpreter, &list->statements[i]);
+    }
+    return code;
+}
+
+// parses pieces read so far into list
+// returns -1 on syntax error, which is printed here
+int parse_pieces(struct script_pieces *pieces, struct statement_list *list)
+{
+    int position = 0;
+
+    int keyword = parse_statements(pieces, &position, list, 0);
+    if (keyword != -2 && pieces->depth > 0)
+    {
+        printf("Syntax Error, Unexpected end of input\n");
+        keyword = -2;
+    }
+    return keyword == -2 ? -1 : 0;
+}
+
+// parses and runs pieces read so far, then clears them
+void run_pieces(struct minibash *interpreter, struct script_pieces *pieces)
+{
+    struct statement_list list = {NULL, 0, 0};
+
+    if (parse_pieces(pieces, &list) == -1)
+    {
+        interpreter->last_exit_status = 2;
+    }
+    else
+    {
+        run_statements(interpreter, &list);
+    }
+    free_statements(&list);
+    clear_pieces(pieces);
+}
+
+// WATCH
+// handle SIGINT while watching, ctrl+c stops watching instead of minibash
+void handle_watch_sigint()
+{
+    is_watch_interrupted = 1;
+}
+
+// starts watching path on inotify fd, a directory for changes of its entries, a file through its directory
+// returns -1 on error
+int add_watch_target(int fd, char *path, struct watch_target *target)
+{
+    struct stat info;
+    uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+    if (stat(path, &info) == -1)
+    {
+        printf("watch: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    target->is_changed = false;
+    if (S_ISDIR(info.st_mode))
+    {
+        target->name = NULL;
+        target->descriptor = inotify_add_watch(fd, path, mask);
+    }
+    else
+    {
+        char *slash = strrchr(path, '/');
+        char *directory = slash ? (slash == path ? strdup("/") : strndup(path, slash - path)) : strdup(".");
+        target->name = strdup(slash ? slash + 1 : path);
+        target->descriptor = inotify_add_watch(fd, directory, mask);
+        free(directory);
+    }
+
+    if (target->descriptor == -1)
+    {
+        printf("watch: %s: %s\n", path, strerror(errno));
+        free(target->name);
+        return -1;
+    }
+    return 0;
+}
+
+// marks targets that events in buffer are about
+// returns number of targets changed
+int mark_watch_targets(char *buffer, ssize_t length, struct watch_target *targets, int targets_num)
+{
+    int changed = 0;
+    for (char *event_data = buffer; event_data < buffer + length;)
+    {
+        struct inotify_event *event = (struct inotify_event *)event_data;
+        event_data += sizeof(struct inotify_event) + event->len;
+
+        for (int i = 0; i < targets_num; i++)
+        {
+            if (targets[i].descriptor == event->wd &&
+                (targets[i].name == NULL || (event->len && strcmp(targets[i].name, event->name) == 0)))
+            {
+                changed += !targets[i].is_changed;
+                targets[i].is_changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+// waits until a target changes, then until there are no more changes for WATCH_DEBOUNCE_MS,
+// so that a burst of writes, i.e. a build or an editor saving, runs command only once
+// returns -1 when watching is interrupted by ctrl+c
+int wait_for_changes(int fd, struct watch_target *targets, int targets_num)
+{
+    long buffer[4096 / sizeof(long)]; // long for alignment of inotify_event
+    int changed = 0;
+
+    for (int i = 0; i < targets_num; i++)
+    {
+        targets[i].is_changed = false;
+    }
+
+    while (!is_watch_interrupted)
+    {
+        struct pollfd poll_fd = {.fd = fd, .events = POLLIN};
+        int ready = poll(&poll_fd, 1, changed ? WATCH_DEBOUNCE_MS : -1);
+        if (ready == 0)
+        {
+            return changed;
+        }
+        if (ready == -1)
+        {
+            continue; // interrupted by a signal
+        }
+
+        ssize_t read_num = read(fd, buffer, sizeof(buffer));
+        if (read_num > 0)
+        {
+            changed += mark_watch_targets((char *)buffer, read_num, targets, targets_num);
+        }
+    }
+    return -1;
+}
+
+// throws away events that are already there, changes made by command itself don't run it again
+void drain_watch_events(int fd)
+{
+    long buffer[4096 / sizeof(long)];
+    while (read(fd, buffer, sizeof(buffer)) > 0)
+        ;
+}
+
+// makes ctrl+c stop watching, old is set to what it did before
+void start_watching(struct sigaction *old)
+{
+    struct sigaction action = {0};
+    action.sa_handler = handle_watch_sigint; // no SA_RESTART, so poll returns on ctrl+c
+    sigemptyset(&action.sa_mask);
+    is_watch_interrupted = 0;
+    sigaction(SIGINT, &action, old);
+}
+
+// frees targets and closes inotify fd, SIGINT gets old handler back unless old is NULL
+void stop_watching(int fd, struct watch_target *targets, int targets_num, struct sigaction *old)
+{
+    for (int i = 0; i < targets_num; i++)
+    {
+        free(targets[i].name);
+    }
+    close(fd);
+    sigaction(SIGINT, old, NULL);
+}
+
+// for watch
+// watch PATH COMMAND [ARGUMENT] runs command, then again every time PATH changes, until ctrl+c
+// command is parsed once and reused on every run, a function can be given to run more than one command
+// returns 0 on success, -1 on error
+int watch_command(struct minibash *interpreter, char *command[])
+{
+    if (command[1] == NULL || command[2] == NULL)
+    {
+        printf("watch: usage: watch PATH COMMAND [ARGUMENT]\n");
+        return -1;
+    }
+
+    struct watch_target target;
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd == -1 || add_watch_target(fd, command[1], &target) == -1)
+    {
+        if (fd != -1)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+
+    struct string_buffer text;
+    string_buffer_init(&text);
+    for (int i = 2; command[i] != NULL; i++)
+    {
+        string_buffer_append(&text, i > 2 ? " " : "");
+        string_buffer_append(&text, command[i]);
+    }
+
+    // watch itself is an input being run, command is an input of its own
+    struct input_state state;
+    struct sigaction old;
+    save_input_state(&state);
+    struct command_plan *plan = malloc(sizeof(struct command_plan));
+    compile_plan(interpreter, plan, text.data);
+    start_watching(&old);
+
+    do
+    {
+        run_plan(interpreter, plan);
+        fflush(stdout);
+        drain_watch_events(fd);
+    } while (wait_for_changes(fd, &target, 1) != -1);
+
+    stop_watching(fd, &target, 1, &old);
+    free_plan(plan);
+    string_buffer_free(&text);
+    restore_input_state(&state);
+    return 0;
+}
+
+// reads and parses lines of a script until end of fd, so that it can be run any number of times
+// returns -1 on syntax error
+int parse_script(struct minibash *interpreter, FILE *fd, struct statement_list *list)
+{
+    struct string_buffer file_data;
+    struct script_pieces pieces = {NULL, 0, 0, 0};
+    string_buffer_init(&file_data);
+
+    while (string_buffer_read_line(&file_data, fd) != -1)
+    {
+        if (file_data.data[strspn(file_data.data, " \t")] != '#' && file_data.length > 0)
+        {
+            char *bodies = read_here_documents(interpreter, file_data.data, fd);
+            add_script_line(&pieces, file_data.data, bodies);
+            free(bodies);
+        }
+    }
+
+    int ret_value = parse_pieces(&pieces, list);
+    clear_pieces(&pieces);
+    free(pieces.pieces);
+    string_buffer_free(&file_data);
+    return ret_value;
+}
+
+// reads and parses whole script, so that it can be run any number of times
+// returns -1 if script can't be read or has a syntax error
+int load_script(struct minibash *interpreter, const char *file_name, struct statement_list *list)
+{
+    FILE *fd = fopen(file_name, "re");
+    if (!fd)
+    {
+        printf("MiniBash Script Not Found\n");
+        return -1;
+    }
+
+    int ret_value = parse_script(interpreter, fd, list);
+    fclose(fd);
+    return ret_value;
+}
+
+// runs script, then again every time script or one of files changes, until ctrl+c
+// script is parsed again only when it changes, otherwise its parsed commands are reused
+int watch_bash_script(struct minibash *interpreter, char *paths[], int paths_num)
+{
+    struct watch_target targets[WATCH_TARGETS_MAX];
+    struct statement_list list = {NULL, 0, 0};
+    struct sigaction old;
+    int targets_num = 0;
+    bool is_loaded = false;
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd == -1)
+    {
+        printf("watch: %s\n", strerror(errno));
+        return -1;
+    }
+    if (paths_num > WATCH_TARGETS_MAX)
+    {
+        printf("watch: Only %d files can be watched\n", WATCH_TARGETS_MAX);
+        close(fd);
+        return -1;
+    }
+    // script is first target
+    for (; targets_num < paths_num; targets_num++)
+    {
+        if (add_watch_target(fd, paths[targets_num], &targets[targets_num]) == -1)
+        {
+            stop_watching(fd, targets, targets_num, NULL);
+            return -1;
+        }
+    }
+    targets[0].is_changed = true;
+    start_watching(&old);
+
+    do
+    {
+        if (targets[0].is_changed)
+        {
+            free_statements(&list);
+            list = (struct statement_list){NULL, 0, 0};
+            is_loaded = load_script(interpreter, paths[0], &list) != -1;
+        }
+        if (is_loaded)
+        {
+            run_statements(interpreter, &list);
+        }
+        fflush(stdout);
+        drain_watch_events(fd);
+    } while (!interpreter->is_exit_requested && wait_for_changes(fd, targets, targets_num) != -1);
+
+    stop_watching(fd, targets, targets_num, &old);
+    free_statements(&list);
+    return 0;
+}
+
+// minibash program
+void minibash(struct minibash *interpreter, char *input_from_script)
+{
+    // buffers are reused across iterations, they only grow when a longer line or path shows up
+    struct string_buffer input, prompt;
+    string_buffer_init(&input);
+    string_buffer_init(&prompt);
+
+    struct script_pieces pieces = {NULL, 0, 0, 0};
+
+    // loop until exit or end of input
+    while (!interpreter->is_exit_requested)
+    {
+        // background processes that are done are told about before prompt, like bash does
+        reap_background_processes(interpreter);
+
+        // PART 0: THE PROMPT
+        // prompt string engineering (this is a joke, obviously)
+        string_buffer_clear(&prompt);
+        string_buffer_append(&prompt, "minibash$");
+        if (get_cwd_path(interpreter))
+        {
+            string_buffer_append(&prompt, interpreter->cwd_path);
+        }
+        string_buffer_append_char(&prompt, '$');
+
+        // PART 1: Take Input, Parse Input
+
+        // prompt and get input
+        char *bodies = NULL;
+        if (input_from_script)
+        {
+            string_buffer_clear(&input);
+            string_buffer_append(&input, input_from_script);
+        }
+        else
+        {
+            // get complete line, no matter how long it is
+            // on EOF (ctrl+d) there is no more input, so exit like the exit command
+            if (read_input_line(interpreter, &input, prompt.data) == -1)
+            {
+                printf("\n");
+                break;
+            }
+            bodies = read_here_documents(interpreter, input.data, NULL);
+        }
+        add_script_line(&pieces, input.data, bodies);
+        free(bodies);
+
+        // loops and conditionals go on until their done or fi
+        while (!input_from_script && pieces.depth > 0)
+        {
+            if (read_input_line(interpreter, &input, "> ") == -1)
+            {
+                printf("\n");
+                break;
+            }
+            bodies = read_here_documents(interpreter, input.data, NULL);
+            add_script_line(&pieces, input.data, bodies);
+            free(bodies);
+        }
+
+        // PART 2 & 3: Tokenize and Perform Commands, every input is compiled into a plan and run
+        run_pieces(interpreter, &pieces);
+
+        // break if script
+        if (input_from_script)
+        {
+            break;
+        }
+    }
+
+    free(pieces.pieces);
+    string_buffer_free(&input);
+    string_buffer_free(&prompt);
+}
+
+// runs lines of a script until end of fd, lines are printed before they run if is_echoed
+void run_script_lines(struct minibash *interpreter, FILE *fd, bool is_echoed)
+{
+    // one buffer for all lines, it grows to fit the longest line in the script
+    struct string_buffer file_data;
+    string_buffer_init(&file_data);
+
+    // lines of a loop or conditional are collected until its end, then it's parsed once and run
+    struct script_pieces pieces = {NULL, 0, 0, 0};
+
+    while (!interpreter->is_exit_requested && string_buffer_read_line(&file_data, fd) != -1)
+    {
+        // printf("File Data:%s\n", file_data.data);
+        // skip comments, they can be indented inside loops and conditionals
+        if (file_data.data[strspn(file_data.data, " \t")] == '#')
+        {
+            continue;
+        }
+
+        if (file_data.length > 0)
+        {
+            if (is_echoed)
+            {
+                printf("\nCommand:%s\n", file_data.data);
+            }
+            char *bodies = read_here_documents(interpreter, file_data.data, fd);
+            add_script_line(&pieces, file_data.data, bodies);
+            free(bodies);
+            if (pieces.depth <= 0)
+            {
+                run_pieces(interpreter, &pieces);
+            }
+        }
+    }
+
+    // a loop or conditional without its done or fi
+    if (pieces.count > 0 && !interpreter->is_exit_requested)
+    {
+        run_pieces(interpreter, &pieces);
+    }
+    clear_pieces(&pieces);
+    free(pieces.pieces);
+    string_buffer_free(&file_data);
+}
+
+// INTERPRETERS
+struct minibash_script
+{
+    struct statement_list list;
+};
+
+// locks shared by threads are taken around fork, so a child never starts with one held by a thread it doesn't have
+// children look commands up in PATH and read history, i.e. stages of a pipe that are functions and $(...)
+void lock_before_fork()
+{
+    pthread_mutex_lock(&shared_paths_lock);
+    pthread_mutex_lock(&history_lock);
+}
+
+void unlock_after_fork()
+{
+    pthread_mutex_unlock(&history_lock);
+    pthread_mutex_unlock(&shared_paths_lock);
+}
+
+pthread_once_t fork_handlers_once = PTHREAD_ONCE_INIT;
+
+void register_fork_handlers()
+{
+    pthread_atfork(lock_before_fork, unlock_after_fork, unlock_after_fork);
+}
+
+// gives this thread a current directory of its own, so interpreters on other threads keep theirs
+// returns false if it can't have one, i.e. a seccomp filter refuses unshare
+bool make_cwd_private()
+{
+    if (!is_cwd_unshare_tried)
+    {
+        is_cwd_private = unshare(CLONE_FS) == 0;
+        is_cwd_unshare_tried = true;
+    }
+    return is_cwd_private;
+}
+
+// makes directory of interpreter current directory of this thread, a thread sharing its directory with the process
+// stays where it is, except in the minibash program
+void enter_interpreter(struct minibash *interpreter)
+{
+    current_interpreter = interpreter;
+
+    if ((make_cwd_private() || is_program) && interpreter->cwd_fd != -1 &&
+        interpreter->cwd_version != thread_cwd_version)
+    {
+        save_thread_cwd();
+        if (fchdir(interpreter->cwd_fd) == 0)
+        {
+            thread_cwd_version = interpreter->cwd_version;
+        }
+    }
+
+    // jobs that ended while interpreter wasn't running are reaped now
+    reap_background_processes(interpreter);
+}
+
+// thread goes back to its own directory
+void leave_interpreter()
+{
+    current_interpreter = NULL;
+    restore_thread_cwd();
+}
+
+// frees what interpreter holds, but not interpreter
+void free_interpreter_state(struct minibash *interpreter)
+{
+    for (int i = 0; i < interpreter->variables_num; i++)
+    {
+        free(interpreter->variables[i].name);
+        free(interpreter->variables[i].value);
+    }
+    free(interpreter->variables);
+    free_command(interpreter->environment_cache);
+    free_command(interpreter->environment_delta_cache);
+
+    for (int i = 0; i < interpreter->name_table_buckets; i++)
+    {
+        struct name_entry *entry = interpreter->name_table[i];
+        while (entry)
+        {
+            struct name_entry *next = entry->next;
+            free(entry->name);
+            free(entry->alias);
+            free(entry->path);
+            release_function(entry->function);
+            free(entry);
+            entry = next;
+        }
+    }
+    free(interpreter->name_table);
+    free(interpreter->background_processes_pids);
+
+    if (interpreter->cwd_fd != -1)
+    {
+        close(interpreter->cwd_fd);
+    }
+    free(interpreter->cwd_path);
+    close_directory(&interpreter->previous_directory);
+    for (int i = 0; i < interpreter->directory_stack_num; i++)
+    {
+        close_directory(&interpreter->directory_stack[i]);
+    }
+    free(interpreter->directory_stack);
+    free(interpreter->home_path);
+    if (interpreter->spawn_channel_fd >= 0)
+    {
+        close(interpreter->spawn_channel_fd);
+    }
+}
+
+struct minibash *minibash_new()
+{
+    struct minibash *interpreter = calloc(1, sizeof(struct minibash));
+    if (!interpreter)
+    {
+        return NULL;
+    }
+
+    // variables and name table are made on first use, like they are for the minibash program
+    interpreter->environment_changed = true;
+    interpreter->spawn_channel_fd = -1;
+    interpreter->previous_directory.fd = -1;
+    pthread_once(&fork_handlers_once, register_fork_handlers);
+
+    // interpreter starts in directory of thread making it, which is then in its directory already
+    make_cwd_private();
+    interpreter->cwd_fd = open(".", O_PATH | O_DIRECTORY | O_CLOEXEC);
+    interpreter->cwd_version = __atomic_add_fetch(&cwd_versions, 1, __ATOMIC_RELAXED);
+    thread_cwd_version = interpreter->cwd_version;
+    return interpreter;
+}
+
+void minibash_free(struct minibash *interpreter)
+{
+    enter_interpreter(interpreter);
+    free_interpreter_state(interpreter);
+    current_interpreter = NULL;
+    restore_thread_cwd();
+    free(interpreter);
+}
+
+int minibash_eval(struct minibash *interpreter, const char *input, int flags)
+{
+    size_t length = strlen(input);
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    enter_interpreter(interpreter);
+
+    // without these there's one command with no redirections, pipes or substitutions
+    is_exec_in_place = (flags & MINIBASH_EXEC_IN_PLACE) && strpbrk(input, "\n;|&+~#<>`(") == NULL;
+
+    // input is only read, mode r doesn't write to it
+    FILE *fd = fmemopen((char *)input, length, "r");
+    if (!fd)
+    {
+        printf("minibash: %s\n", strerror(errno));
+        is_exec_in_place = false;
+        leave_interpreter();
+        return -1;
+    }
+
+    run_script_lines(interpreter, fd, false);
+    fclose(fd);
+    fflush(stdout);
+    is_exec_in_place = false;
+    leave_interpreter();
+    return interpreter->last_exit_status;
+}
+
+int minibash_run_file(struct minibash *interpreter, const char *path, bool is_echoed)
+{
+    enter_interpreter(interpreter);
+
+    FILE *fd = fopen(path, "re"); // e is O_CLOEXEC, commands don't need the script
+    if (!fd)
+    {
+        leave_interpreter();
+        return -1;
+    }
+
+    run_script_lines(interpreter, fd, is_echoed);
+    fclose(fd);
+    fflush(stdout);
+    leave_interpreter();
+    return interpreter->last_exit_status;
+}
+
+int minibash_interactive(struct minibash *interpreter)
+{
+    enter_interpreter(interpreter);
+    minibash(interpreter, NULL);
+    leave_interpreter();
+    return interpreter->last_exit_status;
+}
+
+int minibash_watch(struct minibash *interpreter, char *paths[], int paths_num)
+{
+    enter_interpreter(interpreter);
+    int ret_value = watch_bash_script(interpreter, paths, paths_num);
+    leave_interpreter();
+    return ret_value;
+}
+
+struct minibash_script *minibash_parse(struct minibash *interpreter, const char *input)
+{
+    struct minibash_script *script = malloc(sizeof(struct minibash_script));
+    if (!script)
+    {
+        return NULL;
+    }
+    script->list = (struct statement_list){NULL, 0, 0};
+
+    size_t length = strlen(input);
+    if (length == 0)
+    {
+        return script;
+    }
+
+    FILE *fd = fmemopen((char *)input, length, "r");
+    if (!fd)
+    {
+        printf("minibash: %s\n", strerror(errno));
+        free(script);
+        return NULL;
+    }
+
+    // aliases are replaced while parsing, so they're the ones of interpreter
+    enter_interpreter(interpreter);
+    int ret_value = parse_script(interpreter, fd, &script->list);
+    leave_interpreter();
+    fclose(fd);
+    if (ret_value == -1)
+    {
+        minibash_script_free(script);
+        return NULL;
+    }
+    return script;
+}
+
+int minibash_run(struct minibash *interpreter, struct minibash_script *script)
+{
+    enter_interpreter(interpreter);
+    int code = run_statements(interpreter, &script->list);
+    fflush(stdout);
+    leave_interpreter();
+    return code;
+}
+
+void minibash_script_free(struct minibash_script *script)
+{
+    if (script)
+    {
+        free_statements(&script->list);
+        free(script);
+    }
+}
+
+const char *minibash_get_variable(struct minibash *interpreter, const char *name)
+{
+    enter_interpreter(interpreter);
+    const char *value = get_variable(interpreter, name);
+    leave_interpreter();
+    return value;
+}
+
+void minibash_set_variable(struct minibash *interpreter, const char *name, const char *value, bool is_exported)
+{
+    enter_interpreter(interpreter);
+    set_variable(interpreter, name, strlen(name), value, is_exported);
+    leave_interpreter();
+}
+
+int minibash_jobs(struct minibash *interpreter, pid_t *pids, int pids_max)
+{
+    enter_interpreter(interpreter);
+    int size = find_size(interpreter);
+    for (int i = 0; i < size && i < pids_max; i++)
+    {
+        pids[i] = interpreter->background_processes_pids[i];
+    }
+    leave_interpreter();
+    return size;
+}
+
+bool minibash_is_exiting(struct minibash *interpreter)
+{
+    return interpreter->is_exit_requested;
+}
+
+void minibash_start_spawn_helper()
+{
+    start_spawn_helper();
+}
+
+void minibash_register_instance()
+{
+    is_program = true;
+    if (registry_fd == -1)
+    {
+        register_instance();
+    }
+    signal(SIGCONT, handle_sigint);
+}
+
+void minibash_exit(struct minibash *interpreter, int status)
+{
+    enter_interpreter(interpreter);
+    leave_minibash(interpreter, status);
+}
@@ -0,0 +1,95 @@
+// libminibash, the minibash interpreter as a library
+// minibash.c, the minibash program, is built on it and so can any program which wants to run commands
+// without starting a shell for them
+//
+// an interpreter keeps its variables, functions, aliases, options, background jobs, $? and current directory
+// between inputs, any number of them can be made, each one is independent of the others
+// interpreters can run on any number of threads at once, an interpreter can move between threads but only
+// runs on one at a time, they share where commands were found in PATH and the spawn helper
+// a thread running an interpreter gets a current directory of its own, which is the interpreter's while it runs,
+// so cd of an interpreter changes nothing for other threads, it starts in the directory of the thread making it
+// and the thread is back in its own directory once a call returns
+// where a thread can't have a directory of its own (unshare is refused) interpreters run in the directory of the
+// process and cd fails, except in the minibash program
+// interpreters leave signal handlers of the process alone, background jobs that are done are reaped and told
+// about between commands, only watch handles SIGINT while it watches and minibash_register_instance SIGCONT
+// everything minibash prints goes to stdout of the process
+
+#ifndef MINIBASH_H
+#define MINIBASH_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+// an interpreter
+struct minibash;
+
+// parsed input, it can be run any number of times without being parsed again
+struct minibash_script;
+
+// flags of minibash_eval
+#define MINIBASH_EXEC_IN_PLACE 1 // input which is a single command replaces the process, like sh -c does
+
+// makes a new interpreter, its variables start as a copy of the environment of the process
+// returns NULL if there isn't enough memory
+struct minibash *minibash_new();
+
+// frees interpreter, its background jobs keep running
+void minibash_free(struct minibash *interpreter);
+
+// runs input, which can be more than one line, like lines of a script
+// returns exit code of last command
+int minibash_eval(struct minibash *interpreter, const char *input, int flags);
+
+// runs script from file, every line is printed before it runs if is_echoed
+// returns exit code of last command, -1 if file can't be opened
+int minibash_run_file(struct minibash *interpreter, const char *path, bool is_echoed);
+
+// reads commands from terminal or standard input with a prompt and runs them, until exit or end of input
+// meant for one thread, like minibash_watch, which needs SIGINT
+// returns exit code of last command
+int minibash_interactive(struct minibash *interpreter);
+
+// runs script, then again every time script or one of files changes, until ctrl+c, paths[0] is the script
+// returns -1 on error
+int minibash_watch(struct minibash *interpreter, char *paths[], int paths_num);
+
+// parses input, the same as minibash_eval would, commands are compiled into plans when they first run
+// returns NULL on syntax error, which is printed, or if there isn't enough memory
+struct minibash_script *minibash_parse(struct minibash *interpreter, const char *input);
+
+// runs parsed input with interpreter, any interpreter can run it, but only one at a time
+// returns exit code of last command
+int minibash_run(struct minibash *interpreter, struct minibash_script *script);
+
+void minibash_script_free(struct minibash_script *script);
+
+// returns value of variable, NULL if it isn't set
+// value stays valid until variable changes
+const char *minibash_get_variable(struct minibash *interpreter, const char *name);
+
+// sets variable, it is passed to commands when is_exported
+void minibash_set_variable(struct minibash *interpreter, const char *name, const char *value, bool is_exported);
+
+// copies pids of background jobs into pids, at most pids_max of them
+// returns number of background jobs
+int minibash_jobs(struct minibash *interpreter, pid_t *pids, int pids_max);
+
+// returns true once exit builtin ran, what runs commands stops when it does
+bool minibash_is_exiting(struct minibash *interpreter);
+
+// process wide, starts spawn helper, commands are then forked by a small helper process instead of by this one
+// it runs commands of all interpreters, those of different interpreters at the same time
+// call it before starting threads, so the helper is forked from a small process
+void minibash_start_spawn_helper();
+
+// process wide, for the minibash program rather than for programs embedding interpreters
+// lists process in registry of minibash instances of the user, so instances, dtex and dter find it,
+// and makes SIGCONT end it like exit does
+void minibash_register_instance();
+
+// kills background jobs of interpreter, leaves registry and exits process with status
+void minibash_exit(struct minibash *interpreter, int status);
+
+#endif
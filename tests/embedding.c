@@ -0,0 +1,151 @@
+// checks interpreters of libminibash are independent of each other, also when they run on threads at once,
+// built and run by make test, embedding -helper does the same with commands started by spawn helper
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../minibash.h"
+
+#define THREADS 8
+#define THREAD_RUNS 25
+
+int failures = 0;
+
+// an interpreter on a thread of its own, which works in directory
+struct thread_test
+{
+    pthread_t thread;
+    char directory[PATH_MAX];
+    int failed_runs;
+    bool is_cwd_kept; // thread is back in its own directory after every run
+};
+
+// counts a failure and prints what was expected when is_ok is false
+void check(bool is_ok, const char *what)
+{
+    if (!is_ok)
+    {
+        fprintf(stderr, "embedding: %s\n", what);
+        failures++;
+    }
+}
+
+// returns true if value is set and is expected
+bool is_value(const char *value, const char *expected)
+{
+    return value && strcmp(value, expected) == 0;
+}
+
+// returns true if current directory of thread is still directory
+bool is_in_directory(const char *directory)
+{
+    char cwd[PATH_MAX];
+    return getcwd(cwd, sizeof(cwd)) != NULL && strcmp(cwd, directory) == 0;
+}
+
+// cds into directory of test and makes THREAD_RUNS files there with relative paths
+// history and globs, which threads share or cache, are used as well
+void *run_thread(void *argument)
+{
+    struct thread_test *test = argument;
+    struct minibash *interpreter = minibash_new();
+    char input[PATH_MAX * 3 + 64], cwd[PATH_MAX];
+
+    test->is_cwd_kept = getcwd(cwd, sizeof(cwd)) != NULL;
+    snprintf(input, sizeof(input), "mkdir %s\ncd %s\nHISTFILE=%s/../history", test->directory, test->directory,
+             test->directory);
+    test->failed_runs += minibash_eval(interpreter, input, 0) != 0;
+    test->is_cwd_kept = test->is_cwd_kept && is_in_directory(cwd);
+    for (int i = 0; i < THREAD_RUNS; i++)
+    {
+        snprintf(input, sizeof(input), "N=%d\ntouch file_$N\nhistory 1\necho file_*", i);
+        test->failed_runs += minibash_eval(interpreter, input, 0) != 0;
+        test->is_cwd_kept = test->is_cwd_kept && is_in_directory(cwd);
+    }
+    minibash_free(interpreter);
+    test->is_cwd_kept = test->is_cwd_kept && is_in_directory(cwd);
+    return NULL;
+}
+
+// runs THREADS interpreters at once, each has to make its files in its own directory
+void test_threads(struct minibash *interpreter)
+{
+    struct thread_test tests[THREADS];
+    char directory[] = "/tmp/embedding.XXXXXX";
+    char cwd[PATH_MAX], cwd_after[PATH_MAX], path[PATH_MAX * 2];
+
+    check(mkdtemp(directory) != NULL && getcwd(cwd, sizeof(cwd)) != NULL, "temporary directory not made");
+    for (int i = 0; i < THREADS; i++)
+    {
+        snprintf(tests[i].directory, sizeof(tests[i].directory), "%s/thread_%d", directory, i);
+        tests[i].failed_runs = 0;
+        pthread_create(&tests[i].thread, NULL, run_thread, &tests[i]);
+    }
+
+    for (int i = 0; i < THREADS; i++)
+    {
+        pthread_join(tests[i].thread, NULL);
+        check(tests[i].failed_runs == 0, "command of a thread failed");
+        check(tests[i].is_cwd_kept, "thread not back in its own directory after interpreter ran");
+        for (int j = 0; j < THREAD_RUNS; j++)
+        {
+            snprintf(path, sizeof(path), "%s/file_%d", tests[i].directory, j);
+            check(access(path, F_OK) == 0, "file not made in directory of its interpreter");
+        }
+    }
+    check(getcwd(cwd_after, sizeof(cwd_after)) != NULL && strcmp(cwd, cwd_after) == 0, "cd of a thread moved main thread");
+
+    snprintf(path, sizeof(path), "rm -r %s", directory);
+    minibash_eval(interpreter, path, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "-helper") == 0)
+    {
+        minibash_start_spawn_helper();
+    }
+
+    struct minibash *first = minibash_new();
+    struct minibash *second = minibash_new();
+
+    minibash_set_variable(first, "WHO", "first", false);
+    minibash_eval(second, "WHO=second", 0);
+    check(is_value(minibash_get_variable(first, "WHO"), "first"), "variable of first interpreter changed");
+    check(is_value(minibash_get_variable(second, "WHO"), "second"), "variable of second interpreter not set");
+
+    minibash_eval(first, "alias greet=true\nf() { false; }", 0);
+    check(minibash_eval(first, "f", 0) == 1, "function of first interpreter not run");
+    check(minibash_eval(second, "f", 0) != 1, "function of first interpreter seen by second");
+
+    // a script is parsed once and can then be run by any interpreter
+    struct minibash_script *script = minibash_parse(first, "for i in a b; do\nLAST=$i\ndone");
+    check(script != NULL, "script not parsed");
+    minibash_run(second, script);
+    check(is_value(minibash_get_variable(second, "LAST"), "b"), "parsed script not run by second");
+    check(minibash_get_variable(first, "LAST") == NULL, "parsed script run by first");
+    minibash_script_free(script);
+    check(minibash_parse(first, "if true; then") == NULL, "syntax error not found");
+
+    minibash_eval(second, "exit; WHO=after", 0);
+    check(minibash_is_exiting(second), "exit not seen");
+    check(is_value(minibash_get_variable(second, "WHO"), "second"), "command after exit run");
+    check(!minibash_is_exiting(first), "exit of second interpreter stopped first");
+    check(minibash_eval(first, "true", 0) == 0, "first interpreter stopped running");
+
+    // they kill the minibash program, a program embedding interpreters is never ended by a command
+    check(minibash_eval(first, "dter", 0) != 0 && minibash_eval(first, "dtex", 0) != 0, "dter or dtex not refused");
+
+    test_threads(first);
+
+    minibash_free(first);
+    minibash_free(second);
+    fflush(stdout);
+    if (failures == 0)
+    {
+        fprintf(stderr, "embedding passed\n");
+    }
+    return failures > 0;
+}
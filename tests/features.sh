@@ -0,0 +1,112 @@
+#!/bin/bash
+# runs lines with minibash -c and compares what they print and their exit code with what's expected
+# test_cases only shows a feature runs, these check it does what it should
+# usage: tests/features.sh [minibash binary]
+
+minibash=$(realpath "${1:-minibash-debug}")
+
+directory=$(mktemp -d)
+trap 'rm -rf "$directory"' EXIT
+cd "$directory" || exit 1
+
+failed=0
+
+# check name expected_status expected_output line
+check()
+{
+    local output status
+    output=$(timeout 20 "$minibash" -c "$4" 2>&1)
+    status=$?
+    if [ "$status" -ne "$2" ] || [ "$output" != "$3" ]; then
+        printf 'failed: %s\n  line: %s\n  expected %s: %s\n  got %s: %s\n' "$1" "$4" "$2" "$3" "$status" "$output"
+        failed=1
+    fi
+}
+
+# redirections are applied left to right
+check "2>&1 before > keeps the error on the terminal" 0 "ls: cannot access '/nonexistent': No such file or directory
+0" \
+    'ls /nonexistent 2>&1 > order_1
+wc -c < order_1'
+check "2>&1 after > sends the error to the file" 0 "ls: cannot access '/nonexistent': No such file or directory" \
+    'ls /nonexistent > order_2 2>&1
+cat order_2'
+check ">&2 writes where stderr goes" 0 "to stderr" \
+    'echo to stderr 2> dup_1 >&2
+cat dup_1'
+# a redirection belongs to command it's written in, other commands of a pipe or sequence don't apply it
+check "2> of first command of a pipe" 0 "0
+ls: cannot access '/nonexistent': No such file or directory" \
+    'ls /nonexistent 2> pipe_1 | wc -l
+cat pipe_1'
+check "&> of first command of a pipe" 0 "0
+hi" \
+    'echo hi &> pipe_2 | wc -c
+cat pipe_2'
+check "2> of first command of a sequence" 0 "ok
+ls: cannot access '/nonexistent': No such file or directory" \
+    'ls /nonexistent 2> sequence_1; echo ok
+cat sequence_1'
+check "here strings of two commands" 0 "a
+b" 'cat <<<a; cat <<<b'
+check "functions can be redirected" 0 "in f" \
+    'f() {
+echo in f
+}
+f > function_1
+cat function_1'
+check ">> appends" 0 "one
+two" \
+    'echo one > append_1
+echo two >> append_1
+cat append_1'
+
+# each command of a sequence is expanded right before it runs
+check "variables set earlier in a sequence" 0 "5" 'X=5; echo $X'
+check "\$? of the command before" 0 "1" 'false; echo $?'
+check "\$? after &&" 0 "0" 'true && echo $?'
+check "cd in a sequence" 0 "/tmp" 'cd /tmp; pwd'
+check "cd before &&" 0 "/" 'cd / && pwd'
+
+# a command that isn't found exits with 127 like in sh, whichever way it's started
+check "missing command of -c" 127 "minibash: no_such_command: command not found" 'no_such_command'
+check "\$? of a missing command" 0 "minibash: no_such_command: command not found
+127" 'no_such_command; echo $?'
+
+# here documents
+check "here document" 0 "line one
+line two
+after" \
+    'cat <<EOF
+line one
+line two
+EOF
+echo after'
+check "here document and here string with no space before them" 0 "body
+word" \
+    'cat<<EOF
+body
+EOF
+cat<<<word'
+
+# retry runs a command again until it succeeds, timeout and retry aren't counted towards the word limit
+printf '#!/bin/sh\necho run >> runs\n[ "$(wc -l < runs)" -ge 3 ]\n' > flaky.sh
+chmod +x flaky.sh
+check "retry until success" 0 "3" \
+    'retry 5 ./flaky.sh
+wc -l < runs'
+check "retry in a pipe" 0 "3" \
+    'rm runs
+retry 5 ./flaky.sh | cat
+wc -l < runs'
+check "limit in a pipe" 0 "x" 'limit nofile=64 echo x | cat'
+check "timeout in a pipe" 0 "" 'timeout 0.2 sleep 5 | cat'
+echo a > letters
+check "timeout and retry aren't counted as words" 0 "1" 'timeout 5 retry 2 grep -c a letters'
+check "more than 4 words" 1 "Only 3 Parametes allowed for any Command" 'grep -c a letters letters letters'
+
+if [ "$failed" -ne 0 ]; then
+    echo "features failed"
+    exit 1
+fi
+echo "features passed"